@@ -0,0 +1,24 @@
+#!/bin/bash
+# Builds the headless flight-loop benchmark: the plugin sources without main.cpp, the desktop SDK mock and the benchmark driver. Linux only.
+# usage: src/desktop/benchmark/build.sh [output]
+#   XPLANE_SDK  SDK directory, defaults to SDK at the repository root
+#   UDEV_FLAGS  libudev compile and link flags, defaults to pkg-config's
+#   CXXFLAGS    defaults to -O0, like the plugin's CMake build
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../../.." && pwd)
+OUTPUT=${1:-$ROOT/build/benchmark/flightloop-benchmark}
+XPLANE_SDK=${XPLANE_SDK:-$ROOT/SDK}
+UDEV_FLAGS=${UDEV_FLAGS:-$(pkg-config --cflags --libs libudev)}
+CXXFLAGS=${CXXFLAGS:--O0}
+
+INCLUDES=$(find "$ROOT/src" -name '*.h' -not -path '*/desktop/*' -exec dirname {} \; | sort -u | sed 's/^/-I/')
+SOURCES=$(find "$ROOT/src" -name '*.cpp' -not -path '*/desktop/*' -not -name main.cpp)
+
+mkdir -p "$(dirname "$OUTPUT")"
+g++ -std=c++23 $CXXFLAGS -DAPL=0 -DIBM=0 -DLIN=1 -DXPLM200=1 -DXPLM210=1 -DXPLM300=1 -DXPLM301=1 -DXPLM400=1 -DXPLM410=1 -DXPLM411=1 -DXPLM420=1 \
+    -I"$XPLANE_SDK/CHeaders/XPLM" $INCLUDES \
+    $SOURCES "$ROOT/src/desktop/xplane-sdk-mock.cpp" "$ROOT/src/desktop/benchmark/flightloop-benchmark.cpp" \
+    -o "$OUTPUT" -lpthread $UDEV_FLAGS
+
+echo "Built $OUTPUT"
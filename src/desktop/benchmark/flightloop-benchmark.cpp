@@ -0,0 +1,455 @@
+// Headless benchmark of the plugin flight loops, run against the desktop SDK mock without X-Plane or hardware.
+// Linux only: devices are socketpairs standing in for hidraw nodes, drained by a thread per device. Build with build.sh.
+//
+// usage: flightloop-benchmark render [frames]        CPU time of the FMC, FCU-EFIS and PAP3 display paths, every display changing each frame
+//        flightloop-benchmark loop [frames]          main-thread CPU time of the flight loops with the same load
+//        flightloop-benchmark phase [frames] [loop]  FMC key -> flight model and flight model -> FCU write latency. loop is split (the
+//                                                    input and output flight loops around the flight model), or before / after for a
+//                                                    single loop running both phases at that side of the flight model, as it used to
+#include "appstate.h"
+#include "aircraft-detector.h"
+#include "dataref.h"
+#include "product-fcu-efis.h"
+#include "product-fmc.h"
+#include "product-pap3-mcp.h"
+#include "render-worker.h"
+#include "usbcontroller.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <pthread.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <XPLMDataAccess.h>
+#include <XPLMUtilities.h>
+
+using Clock = std::chrono::steady_clock;
+
+XPLMDataRef createMockDataRef(const char *name, XPLMDataTypeID type);
+void advanceMockCycleNumber();
+
+static constexpr auto FrameInterval = std::chrono::microseconds(16667);
+static constexpr int SettleFrames = 120;
+static constexpr auto FlightModelTime = std::chrono::milliseconds(2);
+static constexpr int PhaseEventInterval = 6;
+
+struct FakeDevice {
+        int pluginEnd;
+        int hostEnd;
+        std::thread drainThread;
+        std::atomic<int64_t> lastWriteAt{0};
+        std::atomic<uint64_t> writes{0};
+};
+
+static std::vector<std::string> fmcRefs;
+
+static const char *intRefs[] = {"AirbusFBW/FCUAvail", "AirbusFBW/AnnunMode", "AirbusFBW/AP1Engage", "AirbusFBW/AP2Engage", "AirbusFBW/ATHRmode", "AirbusFBW/NDrangeCapt",
+    "sim/cockpit/electrical/avionics_on", "sim/time/paused", "laminar/B738/electric/main_bus", "laminar/B738/autopilot/mcp_hdg_dial", "laminar/B738/autopilot/mcp_alt_dial",
+    "laminar/B738/autopilot/vvi_dial_show", "laminar/B738/autopilot/show_ias", "laminar/B738/autopilot/course_pilot", "laminar/B738/autopilot/course_copilot"};
+
+static const char *floatRefs[] = {"sim/cockpit2/autopilot/airspeed_dial_kts_mach", "sim/cockpit/autopilot/heading_mag", "toliss_airbus/pfdoutputs/general/ap_altitude_reference",
+    "sim/cockpit/autopilot/vertical_velocity", "sim/cockpit2/autopilot/vvi_dial_fpm", "sim/cockpit2/gauges/actuators/barometer_setting_in_hg_pilot",
+    "sim/cockpit2/gauges/actuators/barometer_setting_in_hg_copilot", "laminar/B738/autopilot/mcp_speed_dial_kts_mach"};
+
+static const char *floatArrayRefs[] = {"AirbusFBW/DUBrightness", "AirbusFBW/SupplLightLevelRehostats", "laminar/B738/dspl_light_test"};
+
+// CPU time of the calling thread, so time spent preempted by other threads is not counted
+static double threadCpuMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double processCpuMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double threadCpuMicros(std::thread &thread) {
+    clockid_t clock;
+    if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0) {
+        return 0;
+    }
+
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void drain(FakeDevice *device) {
+    uint8_t buffer[4096];
+    while (read(device->hostEnd, buffer, sizeof(buffer)) > 0) {
+        device->lastWriteAt = Clock::now().time_since_epoch().count();
+        device->writes++;
+    }
+}
+
+static FakeDevice *makeDevice() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+        perror("socketpair");
+        exit(1);
+    }
+
+    auto *device = new FakeDevice{.pluginEnd = fds[0], .hostEnd = fds[1]};
+    device->drainThread = std::thread(drain, device);
+    return device;
+}
+
+static void setInt(const char *ref, int value) {
+    XPLMSetDatai(XPLMFindDataRef(ref), value);
+}
+
+static void setFloat(const char *ref, float value) {
+    XPLMSetDataf(XPLMFindDataRef(ref), value);
+}
+
+static void setString(const char *ref, const std::string &value) {
+    XPLMSetDatab(XPLMFindDataRef(ref), (void *) value.c_str(), 0, static_cast<int>(value.size()) + 1);
+}
+
+// A powered Toliss A320 cockpit for the FMC and FCU-EFIS, and a powered Zibo 737 MCP for the PAP3
+static void createCockpit() {
+    for (const char *mcdu : {"MCDU1", "MCDU2"}) {
+        for (const char *suffix : {"titleb", "titleg", "titles", "titlew", "titley", "stitley", "stitlew", "scont1w", "scont2w", "scont3w", "scont4w", "scont5w", "scont6w", "sp"}) {
+            fmcRefs.push_back(std::string("AirbusFBW/") + mcdu + suffix);
+        }
+
+        for (int line = 1; line <= 6; line++) {
+            for (const char *color : {"w", "a", "g", "b", "y", "m", "s"}) {
+                fmcRefs.push_back(std::string("AirbusFBW/") + mcdu + "label" + std::to_string(line) + color);
+                fmcRefs.push_back(std::string("AirbusFBW/") + mcdu + "cont" + std::to_string(line) + color);
+            }
+        }
+    }
+
+    for (const auto &ref : fmcRefs) {
+        createMockDataRef(ref.c_str(), xplmType_Data);
+    }
+    for (const char *ref : intRefs) {
+        createMockDataRef(ref, xplmType_Int);
+    }
+    for (const char *ref : floatRefs) {
+        createMockDataRef(ref, xplmType_Float);
+    }
+    for (const char *ref : floatArrayRefs) {
+        createMockDataRef(ref, xplmType_FloatArray);
+    }
+
+    setInt("AirbusFBW/FCUAvail", 1);
+    setInt("AirbusFBW/AnnunMode", 1);
+    setInt("sim/cockpit/electrical/avionics_on", 1);
+    setInt("laminar/B738/electric/main_bus", 1);
+    setInt("laminar/B738/autopilot/show_ias", 1);
+    setInt("laminar/B738/autopilot/vvi_dial_show", 1);
+
+    float brightness[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+    XPLMSetDatavf(XPLMFindDataRef("AirbusFBW/DUBrightness"), brightness, 0, 8);
+    XPLMSetDatavf(XPLMFindDataRef("AirbusFBW/SupplLightLevelRehostats"), brightness, 0, 2);
+}
+
+// Every FMC line and every FCU, EFIS and MCP value changes, the worst case for the display paths
+static void changeDisplays(int frame, std::mt19937 &random) {
+    static const char charset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789/-. ";
+    for (const auto &ref : fmcRefs) {
+        std::string text(24, ' ');
+        for (auto &c : text) {
+            c = charset[random() % (sizeof(charset) - 1)];
+        }
+        setString(ref.c_str(), text);
+    }
+
+    setFloat("sim/cockpit2/autopilot/airspeed_dial_kts_mach", 150 + frame % 200);
+    setFloat("sim/cockpit/autopilot/heading_mag", frame % 360);
+    setFloat("toliss_airbus/pfdoutputs/general/ap_altitude_reference", 1000 + (frame % 300) * 100);
+    setFloat("sim/cockpit/autopilot/vertical_velocity", (frame % 60) * 100 - 3000);
+    setFloat("sim/cockpit2/gauges/actuators/barometer_setting_in_hg_pilot", 29.0f + (frame % 100) / 100.0f);
+    setFloat("laminar/B738/autopilot/mcp_speed_dial_kts_mach", 150 + frame % 200);
+    setInt("laminar/B738/autopilot/mcp_hdg_dial", frame % 360);
+    setInt("laminar/B738/autopilot/mcp_alt_dial", 1000 + (frame % 300) * 100);
+    setFloat("sim/cockpit2/autopilot/vvi_dial_fpm", (frame % 60) * 100 - 3000);
+}
+
+static std::atomic<int64_t> keyCommandAt{0};
+
+static int keyCommandHandler(XPLMCommandRef command, XPLMCommandPhase phase, void *refcon) {
+    if (phase == xplm_CommandBegin) {
+        keyCommandAt = Clock::now().time_since_epoch().count();
+    }
+
+    return 1;
+}
+
+static void runFrame() {
+    advanceMockCycleNumber();
+    AppState::UpdateInput(0.0f, 0.0f, 1, nullptr);
+    AppState::UpdateOutput(0.0f, 0.0f, 1, nullptr);
+}
+
+static double percentile(std::vector<double> values, double percent) {
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(percent / 100.0 * values.size()));
+    return values[index];
+}
+
+static void report(const char *name, const std::vector<double> &values, const char *unit) {
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+
+    double average = values.empty() ? 0 : sum / values.size();
+    printf("%-36s n=%-5zu avg %8.3f  p50 %8.3f  p99 %8.3f  max %8.3f %s\n", name, values.size(), average, percentile(values, 50), percentile(values, 99), percentile(values, 100), unit);
+}
+
+// Forces each display path to render, then waits for its render worker jobs.
+// Main thread is what the flight loop pays, all threads is the whole render including the worker and the device write thread.
+static void benchmarkRender(int frames, const std::vector<FakeDevice *> &fakeDevices) {
+    auto &devices = USBController::getInstance()->devices;
+    auto *fmc = static_cast<ProductFMC *>(devices[0]);
+    auto *fcu = static_cast<ProductFCUEfis *>(devices[1]);
+    auto *pap3 = static_cast<ProductPAP3MCP *>(devices[2]);
+
+    struct Path {
+            const char *name;
+            USBDevice *device;
+            std::function<void()> render;
+            std::vector<double> mainThread;
+            std::vector<double> allThreads;
+    };
+    std::vector<Path> paths = {
+        {"FMC updatePage", fmc, [fmc]() { fmc->updatePage(true); }},
+        {"FCU-EFIS updateDisplays", fcu, [fcu]() { fcu->updateDisplays(true); }},
+        {"PAP3 updateDisplays", pap3, [pap3]() { pap3->updateDisplays(true); }},
+    };
+
+    auto fakeDeviceCpuMicros = [&fakeDevices]() {
+        double total = 0;
+        for (auto *fakeDevice : fakeDevices) {
+            total += threadCpuMicros(fakeDevice->drainThread);
+        }
+        return total;
+    };
+
+    std::mt19937 random(42);
+    auto nextFrame = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        changeDisplays(frame, random);
+        advanceMockCycleNumber();
+        Dataref::getInstance()->update();
+
+        for (auto &path : paths) {
+            double processStarted = processCpuMicros() - fakeDeviceCpuMicros();
+            double started = threadCpuMicros();
+            path.render();
+            path.mainThread.push_back(threadCpuMicros() - started);
+
+            RenderWorker::getInstance()->waitForJobs(path.device);
+            path.allThreads.push_back(processCpuMicros() - fakeDeviceCpuMicros() - processStarted);
+        }
+
+        nextFrame += FrameInterval;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    for (auto &path : paths) {
+        report((std::string(path.name) + " main thread").c_str(), path.mainThread, "us");
+        report((std::string(path.name) + " all threads").c_str(), path.allThreads, "us");
+    }
+}
+
+static void benchmarkLoop(int frames, const std::vector<FakeDevice *> &fakeDevices) {
+    uint64_t writesBefore = 0;
+    for (auto *fakeDevice : fakeDevices) {
+        writesBefore += fakeDevice->writes;
+    }
+
+    std::vector<double> mainThread;
+    std::mt19937 random(42);
+    auto nextFrame = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        changeDisplays(frame, random);
+
+        double started = threadCpuMicros();
+        runFrame();
+        mainThread.push_back((threadCpuMicros() - started) / 1000.0);
+
+        nextFrame += FrameInterval;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    uint64_t writes = 0;
+    for (auto *fakeDevice : fakeDevices) {
+        writes += fakeDevice->writes;
+    }
+
+    report("flight loops main thread", mainThread, "ms");
+    printf("packets written: %llu\n", static_cast<unsigned long long>(writes - writesBefore));
+}
+
+// One simulated frame is the before flight model phase, the flight model, then the after flight model phase.
+// FMC key reports arrive at random points in the frame, the flight model sees a key once its command has run.
+// The flight model toggles AP1, which the FCU shows once the output phase has rendered and written it.
+static void benchmarkPhase(int frames, const std::string &loop, const std::vector<FakeDevice *> &fakeDevices) {
+    auto &devices = USBController::getInstance()->devices;
+    FakeDevice *fmcDevice = fakeDevices[0];
+    FakeDevice *fcuDevice = fakeDevices[1];
+
+    bool inputBefore = loop == "split" || loop == "before";
+    bool outputBefore = loop == "before";
+    XPLMRegisterCommandHandler(XPLMFindCommand("AirbusFBW/MCDU1LSK1L"), keyCommandHandler, 1, nullptr);
+
+    std::vector<double> keyToFlightModel;
+    std::vector<double> flightModelToWrite;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> pressOffsetMicros(0, static_cast<int>(FrameInterval.count()) - 1);
+
+    std::thread presser;
+    std::atomic<int64_t> pressedAt{0};
+    bool keyDown = false;
+    bool pressPending = false;
+
+    int apEngaged = 0;
+    int64_t changedAt = 0;
+    uint64_t writesAtChange = 0;
+    bool changePending = false;
+
+    auto nextFrame = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        advanceMockCycleNumber();
+
+        if (frame % PhaseEventInterval == 0 && !pressPending) {
+            if (presser.joinable()) {
+                presser.join();
+            }
+
+            keyDown = !keyDown;
+            pressPending = keyDown;
+            int offset = pressOffsetMicros(random);
+            presser = std::thread([fmcDevice, offset, down = keyDown, &pressedAt]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(offset));
+                uint8_t report[14] = {1, static_cast<uint8_t>(down ? 1 : 0)};
+                pressedAt = Clock::now().time_since_epoch().count();
+                write(fmcDevice->hostEnd, report, sizeof(report));
+            });
+        }
+
+        if (inputBefore) {
+            AppState::UpdateInput(0.0f, 0.0f, 1, nullptr);
+        }
+        if (outputBefore) {
+            AppState::UpdateOutput(0.0f, 0.0f, 1, nullptr);
+        }
+
+        std::this_thread::sleep_for(FlightModelTime);
+        int64_t flightModelAt = Clock::now().time_since_epoch().count();
+        if (pressPending && pressedAt.load() != 0 && keyCommandAt.load() >= pressedAt.load()) {
+            keyToFlightModel.push_back((flightModelAt - pressedAt) / 1e6);
+            pressPending = false;
+            pressedAt = 0;
+        }
+
+        if (changePending && fcuDevice->writes > writesAtChange) {
+            flightModelToWrite.push_back((fcuDevice->lastWriteAt - changedAt) / 1e6);
+            changePending = false;
+        }
+        if (!changePending && frame % PhaseEventInterval == PhaseEventInterval / 2) {
+            apEngaged = !apEngaged;
+            writesAtChange = fcuDevice->writes;
+            setInt("AirbusFBW/AP1Engage", apEngaged);
+            changedAt = Clock::now().time_since_epoch().count();
+            changePending = true;
+        }
+
+        if (!inputBefore) {
+            AppState::UpdateInput(0.0f, 0.0f, 1, nullptr);
+        }
+        if (!outputBefore) {
+            AppState::UpdateOutput(0.0f, 0.0f, 1, nullptr);
+        }
+
+        nextFrame += FrameInterval;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    if (presser.joinable()) {
+        presser.join();
+    }
+
+    report("FMC key -> flight model", keyToFlightModel, "ms");
+    report("flight model -> FCU write", flightModelToWrite, "ms");
+
+    // What the devices' latency trackers published for their last window
+    auto printStage = [](USBDevice *device, LatencyStage stage) {
+        const auto &summary = device->latency.summary(stage);
+        printf("tracker %s %s: p50 %.2f ms, p99 %.2f ms, max %.2f ms (%d samples)\n", device->classIdentifier(), LatencyTracker::stageName(stage), summary.p50, summary.p99, summary.max,
+            summary.count);
+    };
+    printStage(devices[0], LatencyStage::INPUT_COMMAND);
+    printStage(devices[1], LatencyStage::OUTPUT_WRITE);
+}
+
+int main(int argc, char **argv) {
+    std::string mode = argc > 1 ? argv[1] : "render";
+    int frames = argc > 2 ? atoi(argv[2]) : 1800;
+    std::string loop = argc > 3 ? argv[3] : "split";
+    bool validLoop = loop == "split" || loop == "before" || loop == "after";
+    if ((mode != "render" && mode != "loop" && mode != "phase") || frames <= 0 || !validLoop) {
+        fprintf(stderr, "usage: %s render|loop [frames]\n       %s phase [frames] [split|before|after]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    createCockpit();
+
+    auto *controller = USBController::getInstance();
+    AppState::getInstance()->pluginInitialized = true;
+    AppState::getInstance()->debuggingEnabled = false;
+
+    std::vector<FakeDevice *> fakeDevices = {makeDevice(), makeDevice(), makeDevice()};
+    controller->devices.push_back(USBDevice::Device(fakeDevices[0]->pluginEnd, 0x4098, 0xBB36, "WINCTRL", "MCDU-32-CAPTAIN"));
+    controller->devices.push_back(USBDevice::Device(fakeDevices[1]->pluginEnd, 0x4098, 0xBA01, "WINCTRL", "FCU-EFIS"));
+    controller->devices.push_back(USBDevice::Device(fakeDevices[2]->pluginEnd, 0x4098, 0xBF0F, "WINCTRL", "PAP3-MCP"));
+    AircraftDetector::getInstance()->planeLoaded();
+
+    // Lets the profiles load and the initial display state go out
+    auto nextFrame = Clock::now();
+    for (int frame = 0; frame < SettleFrames; frame++) {
+        runFrame();
+        nextFrame += FrameInterval;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    for (auto *device : controller->devices) {
+        if (!device->profileReady) {
+            fprintf(stderr, "%s has no profile for the mock cockpit\n", device->classIdentifier());
+            return 1;
+        }
+    }
+
+    if (mode == "render") {
+        benchmarkRender(frames, fakeDevices);
+    } else if (mode == "loop") {
+        benchmarkLoop(frames, fakeDevices);
+    } else {
+        benchmarkPhase(frames, loop, fakeDevices);
+    }
+
+    // Device threads block on the fake devices, skip their teardown
+    fflush(stdout);
+    _exit(0);
+}
@@ -22,6 +22,7 @@ typedef int XPLMDataTypeID;
 XPLMDataRef XPLMFindDataRef(const char* name);
 XPLMDataRef createMockDataRefWithInference(const char* name, XPLMDataTypeID preferredType);
 void clearAllMockDataRefs();
+void advanceMockCycleNumber();
 
 
 // Helper function to ensure dataref exists before setting
@@ -104,7 +105,9 @@ void setDatarefIntVector(const char* ref, const int* values, int count) {
 
 void update() {
     AppState::getInstance()->pluginInitialized = true;
-    AppState::Update(0.0f, 0.0f, 1, nullptr);
+    advanceMockCycleNumber();
+    AppState::UpdateInput(0.0f, 0.0f, 1, nullptr);
+    AppState::UpdateOutput(0.0f, 0.0f, 1, nullptr);
 }
 
 void disconnectAll() {
@@ -182,6 +185,7 @@ void device_update(void* deviceHandle) {
     if (!deviceHandle) return;
     auto device = static_cast<USBDevice*>(deviceHandle);
     device->update();
+    device->render();
 }
 
 void device_force_state_sync(void* deviceHandle) {
@@ -429,7 +433,7 @@ void fcuefis_testDisplay(void* fcuefisHandle, const char* testType) {
     
     // Send test pattern to both EFIS displays
     EfisDisplayValue efisData;
-    efisData.baro = "8888";
+    SegmentDisplay::writeText(efisData.baro, "8888");
     efisData.unitIsInHg = false;
     efisData.showQfe = false;
     fcuefis->sendEfisDisplayWithFlags(&efisData, true);  // Right
@@ -445,19 +449,19 @@ void fcuefis_efisRightTestDisplay(void* fcuefisHandle, const char* testType) {
     
     if (test == "QNH_1013") {
         // hPa: QNH mode but no decimal point
-        efisData.baro = "1013";
+        SegmentDisplay::writeText(efisData.baro, "1013");
         efisData.unitIsInHg = false;
         efisData.showQfe = false;
         fcuefis->sendEfisDisplayWithFlags(&efisData, true);
     } else if (test == "QNH_2992") {
         // inHg: show decimal point to display "29.92"
-        efisData.baro = "2992";
+        SegmentDisplay::writeText(efisData.baro, "2992");
         efisData.unitIsInHg = true;
         efisData.showQfe = false;
         fcuefis->sendEfisDisplayWithFlags(&efisData, true);
     } else if (test == "STD") {
         // STD: no decimal point
-        efisData.baro = "";
+        SegmentDisplay::writeText(efisData.baro, "");
         efisData.isStd = true;
         efisData.unitIsInHg = false;
         efisData.showQfe = false;
@@ -474,19 +478,19 @@ void fcuefis_efisLeftTestDisplay(void* fcuefisHandle, const char* testType) {
     
     if (test == "QNH_1013") {
         // hPa: QNH mode but no decimal point
-        efisData.baro = "1013";
+        SegmentDisplay::writeText(efisData.baro, "1013");
         efisData.unitIsInHg = false;
         efisData.showQfe = false;
         fcuefis->sendEfisDisplayWithFlags(&efisData, false);
     } else if (test == "QNH_2992") {
         // inHg: show decimal point to display "29.92"
-        efisData.baro = "2992";
+        SegmentDisplay::writeText(efisData.baro, "2992");
         efisData.unitIsInHg = true;
         efisData.showQfe = false;
         fcuefis->sendEfisDisplayWithFlags(&efisData, false);
     } else if (test == "STD") {
         // STD: no decimal point
-        efisData.baro = "";
+        SegmentDisplay::writeText(efisData.baro, "");
         efisData.isStd = true;
         efisData.unitIsInHg = false;
         efisData.showQfe = false;
@@ -499,7 +503,7 @@ void fcuefis_efisRightClear(void* fcuefisHandle) {
     auto fcuefis = static_cast<ProductFCUEfis*>(fcuefisHandle);
     
     EfisDisplayValue efisData;
-    efisData.baro = "    ";  // Clear with 4 spaces
+    SegmentDisplay::writeText(efisData.baro, "    ");  // Clear with 4 spaces
     efisData.unitIsInHg = false;
     efisData.showQfe = false;
     fcuefis->sendEfisDisplayWithFlags(&efisData, true);
@@ -510,7 +514,7 @@ void fcuefis_efisLeftClear(void* fcuefisHandle) {
     auto fcuefis = static_cast<ProductFCUEfis*>(fcuefisHandle);
     
     EfisDisplayValue efisData;
-    efisData.baro = "    ";  // Clear with 4 spaces
+    SegmentDisplay::writeText(efisData.baro, "    ");  // Clear with 4 spaces
     efisData.unitIsInHg = false;
     efisData.showQfe = false;
     fcuefis->sendEfisDisplayWithFlags(&efisData, false);
@@ -10,8 +10,8 @@
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <chrono>
 #include <cstring>
-#include <ctime>
 
 // Forward declarations for XPLM types (they are defined as void* in the actual headers)
 typedef void* XPLMCommandRef;
@@ -54,14 +54,23 @@ size_t dataRefHandleToIndex(XPLMDataRef ref) {
     return reinterpret_cast<size_t>(ref) - 1000;
 }
 
+struct MockCommandHandler {
+    XPLMCommandRef ref;
+    XPLMCommandCallback_f handler;
+    int before;
+    void *refcon;
+};
+
 XPLMMenuID mainMenuId = 0;
 static std::vector<std::string> registeredCommands = {};
+static std::vector<MockCommandHandler> commandHandlers = {};
 static std::vector<MockDataRef> mockDataRefs = {};
 static std::unordered_map<std::string, size_t> dataRefNameToIndex = {};
 
 // Function to clear all mock dataref storage
 void clearAllMockDataRefs() {
     registeredCommands.clear();
+    commandHandlers.clear();
     mockDataRefs.clear();
     dataRefNameToIndex.clear();
 }
@@ -149,6 +158,16 @@ MockDataRef* getOrCreateDataRefByName(const char* name, XPLMDataTypeID preferred
     return &mockDataRefs[index];
 }
 
+static void invokeCommandHandlers(XPLMCommandRef ref, int phase) {
+    // Copied, a handler may unregister itself
+    auto handlers = commandHandlers;
+    for (const auto &entry : handlers) {
+        if (entry.ref == ref) {
+            entry.handler(ref, phase, entry.refcon);
+        }
+    }
+}
+
 void XPLMCommandBegin(XPLMCommandRef ref) {
     int idx = static_cast<int>(reinterpret_cast<intptr_t>(ref)) - 1;
     if (idx >= 0 && idx < static_cast<int>(registeredCommands.size())) {
@@ -156,6 +175,8 @@ void XPLMCommandBegin(XPLMCommandRef ref) {
     } else {
         printf("Executing command (start): invalid ref\n");
     }
+
+    invokeCommandHandlers(ref, xplm_CommandBegin);
 }
 
 void XPLMCommandEnd(XPLMCommandRef ref) {
@@ -166,6 +187,8 @@ void XPLMCommandEnd(XPLMCommandRef ref) {
         printf("Executing command (end): invalid ref\n");
     }
 
+    invokeCommandHandlers(ref, xplm_CommandEnd);
+
     if (registeredCommands[idx] == "AirbusFBW/MCDU1KeyBright" || registeredCommands[idx] == "AirbusFBW/MCDU1KeyDim") {
         float brightness = registeredCommands[idx] == "AirbusFBW/MCDU1KeyDim" ? 0.2 : 0.8;
         Dataref::getInstance()->set<float>("AirbusFBW/PanelBrightnessLevel", brightness, true);
@@ -180,6 +203,9 @@ void XPLMCommandOnce(XPLMCommandRef ref) {
     } else {
         printf("Executing command (once): invalid ref\n");
     }
+
+    invokeCommandHandlers(ref, xplm_CommandBegin);
+    invokeCommandHandlers(ref, xplm_CommandEnd);
 }
 
 XPLMCommandRef XPLMCreateCommand(const char *name, const char *desc) {
@@ -354,12 +380,19 @@ int XPLMGetDatavi(XPLMDataRef ref, int *values, int offset, int max) {
 }
 
 void XPLMRegisterCommandHandler(XPLMDataRef ref, XPLMCommandCallback_f handler, int before, void *refcon) {
+    commandHandlers.push_back({ref, handler, before, refcon});
 }
 
 // Mock implementations for missing XPLM functions
 
 void XPLMUnregisterCommandHandler(XPLMDataRef ref, XPLMCommandCallback_f handler, int before, void *refcon) {
     printf("Unregistering command handler\n");
+    auto it = std::find_if(commandHandlers.begin(), commandHandlers.end(), [&](const MockCommandHandler &entry) {
+        return entry.ref == ref && entry.handler == handler && entry.before == before && entry.refcon == refcon;
+    });
+    if (it != commandHandlers.end()) {
+        commandHandlers.erase(it);
+    }
 }
 
 void XPLMUnregisterDataAccessor(XPLMDataRef ref) {
@@ -529,8 +562,32 @@ void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, void *inRef
     
 }
 
+XPLMFlightLoopID XPLMCreateFlightLoop(XPLMCreateFlightLoop_t *inParams) {
+    return nullptr;
+}
+
+void XPLMDestroyFlightLoop(XPLMFlightLoopID inFlightLoopID) {
+    
+}
+
+void XPLMScheduleFlightLoop(XPLMFlightLoopID inFlightLoopID, float inInterval, int inRelativeToNow) {
+    
+}
+
+// X-Plane advances the cycle once per frame; the bridge drives frames through update()
+static int mockCycleNumber = 0;
+static const auto mockStartTime = std::chrono::steady_clock::now();
+
+void advanceMockCycleNumber() {
+    mockCycleNumber++;
+}
+
 int XPLMGetCycleNumber() {
-    return static_cast<int>(std::time(nullptr));
+    return mockCycleNumber;
+}
+
+float XPLMGetElapsedTime() {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - mockStartTime).count();
 }
 
 XPLMMenuID XPLMCreateMenu(const char *inName, XPLMMenuID inParentMenu, int inParentItem, XPLMMenuHandler_f inHandler, void *inMenuRef) {
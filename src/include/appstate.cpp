@@ -1,11 +1,15 @@
 #include "appstate.h"
 
 #include "config.h"
+#include "dataref-profiler.h"
 #include "dataref.h"
-#include "SimpleIni.h"
+#include "frame-governor.h"
+#include "haptics-engine.h"
+#include "preferences.h"
 #include "usbcontroller.h"
 #include "usbdevice.h"
 
+#include <algorithm>
 #include <fstream>
 #include <XPLMProcessing.h>
 
@@ -33,7 +37,16 @@ bool AppState::initialize() {
         return false;
     }
 
-    XPLMRegisterFlightLoopCallback(AppState::Update, REFRESH_INTERVAL_SECONDS_FAST, nullptr);
+    XPLMCreateFlightLoop_t inputLoop = {sizeof(XPLMCreateFlightLoop_t), xplm_FlightLoop_Phase_BeforeFlightModel, AppState::UpdateInput, nullptr};
+    inputFlightLoop = XPLMCreateFlightLoop(&inputLoop);
+    XPLMScheduleFlightLoop(inputFlightLoop, REFRESH_INTERVAL_SECONDS_FAST, 1);
+
+    XPLMCreateFlightLoop_t outputLoop = {sizeof(XPLMCreateFlightLoop_t), xplm_FlightLoop_Phase_AfterFlightModel, AppState::UpdateOutput, nullptr};
+    outputFlightLoop = XPLMCreateFlightLoop(&outputLoop);
+    XPLMScheduleFlightLoop(outputFlightLoop, REFRESH_INTERVAL_SECONDS_FAST, 1);
+
+    frameGovernor.setBudget(Preferences::getInstance()->getFloat("FrameBudgetMs", FrameGovernor::DefaultBudgetMs));
+    frameGovernor.bindDatarefs();
 
     pluginInitialized = true;
 
@@ -59,23 +72,42 @@ void AppState::deinitialize() {
     }
 
     debug_force("Plugin deinitializing...\n");
-    XPLMUnregisterFlightLoopCallback(AppState::Update, nullptr);
+    if (inputFlightLoop) {
+        XPLMDestroyFlightLoop(inputFlightLoop);
+        inputFlightLoop = nullptr;
+    }
+
+    if (outputFlightLoop) {
+        XPLMDestroyFlightLoop(outputFlightLoop);
+        outputFlightLoop = nullptr;
+    }
 
     USBController::getInstance()->destroy();
+    UsbTelemetry::resetConnectionHistory();
 
+    frameGovernor.unbindDatarefs();
     Dataref::getInstance()->destroyAllBindings();
 
     pluginInitialized = false;
 
-    taskQueue.clear();
+    scheduler.clear();
+    refreshSlots.clear();
 
     instance = nullptr;
 }
 
-float AppState::Update(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon) {
-    auto appstate = AppState::getInstance();
+float AppState::UpdateInput(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon) {
+    AppState::getInstance()->updateInput();
+
+    if (!USBController::getInstance()->anyProfileReady()) {
+        return REFRESH_INTERVAL_SECONDS_SLOW;
+    }
+
+    return REFRESH_INTERVAL_SECONDS_FAST;
+}
 
-    appstate->update();
+float AppState::UpdateOutput(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon) {
+    AppState::getInstance()->updateOutput();
 
     if (!USBController::getInstance()->anyProfileReady()) {
         return REFRESH_INTERVAL_SECONDS_SLOW;
@@ -84,77 +116,149 @@ float AppState::Update(float inElapsedSinceLastCall, float inElapsedTimeSinceLas
     return REFRESH_INTERVAL_SECONDS_FAST;
 }
 
-void AppState::update() {
-    auto now = std::chrono::steady_clock::now();
+void AppState::updateInput() {
+    frameGovernor.beginFrame();
 
-    for (size_t i = 0; i < taskQueue.size(); ++i) {
-        if (now >= taskQueue[i].runAt && taskQueue[i].func) {
-            taskQueue[i].func();
-        }
+    if (!pluginInitialized) {
+        return;
     }
 
-    taskQueue.erase(std::remove_if(taskQueue.begin(), taskQueue.end(), [&](auto &task) {
-        return now >= task.runAt;
-    }),
-        taskQueue.end());
+    auto startedAt = std::chrono::steady_clock::now();
+    for (auto *device : USBController::getInstance()->devices) {
+        DatarefProfiler::Scope profilerScope(device->classIdentifier());
+        device->update();
+    }
+    frameGovernor.record(FrameSubsystem::INPUT, startedAt);
+}
+
+void AppState::updateOutput() {
+    auto now = std::chrono::steady_clock::now();
+
+    scheduler.runDue(now);
+    frameGovernor.record(FrameSubsystem::TASKS, now);
 
     if (!pluginInitialized) {
         return;
     }
 
+    auto startedAt = std::chrono::steady_clock::now();
     Dataref::getInstance()->update();
+    HapticsEngine::getInstance()->sample();
+    frameGovernor.record(FrameSubsystem::DATAREFS, startedAt);
+
+    scheduleRefreshes(now);
 
     for (auto *device : USBController::getInstance()->devices) {
-        device->update();
+        startedAt = std::chrono::steady_clock::now();
+        DatarefProfiler::Scope profilerScope(device->classIdentifier());
+        device->render();
+        frameGovernor.record(FrameSubsystem::RENDER, startedAt);
+        device->telemetry.recordRender(std::chrono::steady_clock::now() - startedAt);
+
+        device->latency.endOutput();
+        device->latency.publish(device->deviceKey());
+        device->telemetry.publish(device->deviceKey(), device->getWriteQueueSize());
     }
+
+    frameGovernor.endFrame();
+    frameGovernor.publish();
 }
 
-void AppState::executeAfter(int milliseconds, std::function<void()> func) {
-    taskQueue.push_back({"", std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds), func});
+TaskHandle AppState::executeAfter(int milliseconds, std::function<void()> func) {
+    return scheduler.schedule(std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds), std::move(func));
 }
 
-void AppState::executeAfterDebounced(std::string taskName, int milliseconds, std::function<void()> func) {
-    auto now = std::chrono::steady_clock::now();
-    auto it = std::find_if(taskQueue.begin(), taskQueue.end(), [&](const DelayedTask &t) {
-        return t.name == taskName;
+TaskHandle AppState::executeAfterDebounced(const std::string &taskName, int milliseconds, std::function<void()> func) {
+    return scheduler.scheduleDebounced(taskName, std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds), std::move(func));
+}
+
+bool AppState::cancelTask(TaskHandle handle) {
+    return scheduler.cancel(handle);
+}
+
+void AppState::registerRefresh(const void *owner, float hz, int latencyBudgetMs) {
+    unregisterRefresh(owner);
+
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / hz));
+    refreshSlots.push_back({
+        .owner = owner,
+        .interval = interval,
+        .latencyBudget = std::chrono::milliseconds(latencyBudgetMs),
+        .nextRefreshAt = std::chrono::steady_clock::now(),
+        .due = false,
     });
+}
 
-    if (it != taskQueue.end()) {
-        it->runAt = now + std::chrono::milliseconds(milliseconds);
-        it->func = func;
-    } else {
-        taskQueue.push_back({taskName, now + std::chrono::milliseconds(milliseconds), func});
-    }
+void AppState::unregisterRefresh(const void *owner) {
+    refreshSlots.erase(std::remove_if(refreshSlots.begin(), refreshSlots.end(), [owner](const RefreshSlot &slot) {
+        return slot.owner == owner;
+    }),
+        refreshSlots.end());
 }
 
-std::string AppState::readPreference(const std::string &key, const std::string &defaultValue) {
-    CSimpleIniA ini;
-    ini.SetUnicode();
-    SI_Error rc = ini.LoadFile((getPluginDirectory() + "/preferences.ini").c_str());
-    if (rc < 0) {
-        return defaultValue;
+bool AppState::shouldRefresh(const void *owner, int backoff) {
+    auto it = std::find_if(refreshSlots.begin(), refreshSlots.end(), [owner](const RefreshSlot &slot) {
+        return slot.owner == owner;
+    });
+
+    if (it == refreshSlots.end() || !it->due) {
+        return false;
     }
 
-    const char *value = ini.GetValue("Preferences", key.c_str(), defaultValue.c_str());
-    return std::string(value);
-}
+    it->due = false;
 
-void AppState::writePreference(const std::string &key, const std::string &value) {
-    CSimpleIniA ini;
-    ini.SetUnicode();
-    SI_Error rc = ini.LoadFile((getPluginDirectory() + "/preferences.ini").c_str());
-    if (rc < 0) {
-        // File might not exist yet, continue
+    // Once the frame budget is spent, refreshes that can still meet their latency budget wait for the next loop
+    if (frameGovernor.overBudget() && lastUpdateAt < it->nextRefreshAt + it->latencyBudget) {
+        frameGovernor.markDeferred();
+        return false;
     }
 
-    ini.SetValue("Preferences", key.c_str(), value.c_str());
+    it->nextRefreshAt += it->interval * std::max(backoff, 1);
+    if (it->nextRefreshAt < lastUpdateAt) {
+        it->nextRefreshAt = lastUpdateAt;
+    }
+
+    return true;
+}
 
-    rc = ini.SaveFile((getPluginDirectory() + "/preferences.ini").c_str());
-    if (rc < 0) {
-        debug_force("Failed to save preferences file.\n");
+void AppState::scheduleRefreshes(std::chrono::steady_clock::time_point now) {
+    auto frameTime = lastUpdateAt.time_since_epoch().count() ? now - lastUpdateAt : std::chrono::steady_clock::duration::zero();
+    lastUpdateAt = now;
+
+    // Earliest deadline first. Only one device refreshes per flight loop, unless waiting another loop would exceed its latency budget.
+    std::sort(refreshSlots.begin(), refreshSlots.end(), [](const RefreshSlot &a, const RefreshSlot &b) {
+        return a.nextRefreshAt + a.latencyBudget < b.nextRefreshAt + b.latencyBudget;
+    });
+
+    bool anyDue = false;
+    for (auto &slot : refreshSlots) {
+        if (slot.due) {
+            // The device skipped its refresh last loop, e.g. because it has no profile
+            slot.nextRefreshAt = now + slot.interval;
+        }
+
+        slot.due = false;
+        if (now < slot.nextRefreshAt) {
+            continue;
+        }
+
+        if (anyDue && now + frameTime < slot.nextRefreshAt + slot.latencyBudget) {
+            continue;
+        }
+
+        slot.due = true;
+        anyDue = true;
     }
 }
 
+std::string AppState::readPreference(const std::string &key, const std::string &defaultValue) {
+    return Preferences::getInstance()->get(key, defaultValue);
+}
+
+void AppState::writePreference(const std::string &key, const std::string &value) {
+    Preferences::getInstance()->set(key, value);
+}
+
 std::string AppState::getPluginDirectory() {
     char systemPath[512];
     XPLMGetSystemPath(systemPath);
@@ -1,15 +1,21 @@
 #ifndef APPSTATE_H
 #define APPSTATE_H
 
+#include "frame-governor.h"
+#include "task-scheduler.h"
+
 #include <chrono>
 #include <functional>
 #include <string>
 #include <vector>
+#include <XPLMProcessing.h>
 
-struct DelayedTask {
-        std::string name;
-        std::chrono::steady_clock::time_point runAt;
-        std::function<void()> func;
+struct RefreshSlot {
+        const void *owner;
+        std::chrono::steady_clock::duration interval;
+        std::chrono::steady_clock::duration latencyBudget;
+        std::chrono::steady_clock::time_point nextRefreshAt;
+        bool due;
 };
 
 class AppState {
@@ -18,22 +24,38 @@ class AppState {
         ~AppState();
 
         static AppState *instance;
-        std::vector<DelayedTask> taskQueue;
-        void update();
+        TaskScheduler scheduler;
+        std::vector<RefreshSlot> refreshSlots;
+        std::chrono::steady_clock::time_point lastUpdateAt;
+        XPLMFlightLoopID inputFlightLoop = nullptr;
+        XPLMFlightLoopID outputFlightLoop = nullptr;
+        void updateInput();
+        void updateOutput();
+        void scheduleRefreshes(std::chrono::steady_clock::time_point now);
 
     public:
-        static float Update(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
+        // Device input is dispatched before the flight model runs, so commands apply in the same frame.
+        // Datarefs are sampled and displays rendered after it, so outputs reflect the frame that was just simulated.
+        static float UpdateInput(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
+        static float UpdateOutput(float inElapsedSinceLastCall, float inElapsedTimeSinceLastFlightLoop, int inCounter, void *inRefcon);
 
         bool pluginInitialized;
         bool debuggingEnabled;
+        FrameGovernor frameGovernor;
 
         static AppState *getInstance();
         bool initialize();
         void deinitialize();
         std::string getPluginDirectory();
 
-        void executeAfter(int milliseconds, std::function<void()> func);
-        void executeAfterDebounced(std::string taskName, int milliseconds, std::function<void()> func);
+        TaskHandle executeAfter(int milliseconds, std::function<void()> func);
+        TaskHandle executeAfterDebounced(const std::string &taskName, int milliseconds, std::function<void()> func);
+        bool cancelTask(TaskHandle handle);
+
+        // Display refresh is paced by wall-clock time instead of X-Plane frames
+        void registerRefresh(const void *owner, float hz, int latencyBudgetMs);
+        void unregisterRefresh(const void *owner);
+        bool shouldRefresh(const void *owner, int backoff = 1);
 
         std::string readPreference(const std::string &key, const std::string &defaultValue);
         void writePreference(const std::string &key, const std::string &value);
@@ -2,39 +2,33 @@
 #include <windows.h>
 #endif
 
+#include "logger.h"
+
+#include <cstdio>
+
+// The level is checked before anything is formatted, formatting and writing happen in Logger.
+// Debug builds still print debug() lines to stdout while debug logging is off.
 #if DEBUG
-#define debug(format, ...)                                                    \
-    {                                                                         \
-        char buffer[1024];                                                    \
-        snprintf(buffer, sizeof(buffer), "[WINCTRL] " format, ##__VA_ARGS__); \
-        if (AppState::getInstance()->debuggingEnabled) {                      \
-            XPLMDebugString(buffer);                                          \
-        }                                                                     \
-        printf("%s", buffer);                                                 \
-    }
-#define debug_force(format, ...)                                              \
-    {                                                                         \
-        char buffer[1024];                                                    \
-        snprintf(buffer, sizeof(buffer), "[WINCTRL] " format, ##__VA_ARGS__); \
-        XPLMDebugString(buffer);                                              \
-        printf("%s", buffer);                                                 \
+#define debug(format, ...)                                                   \
+    {                                                                        \
+        if (AppState::getInstance()->debuggingEnabled) {                     \
+            Logger::getInstance()->log("[WINCTRL] " format, ##__VA_ARGS__); \
+        } else {                                                             \
+            printf("[WINCTRL] " format, ##__VA_ARGS__);                      \
+        }                                                                    \
     }
 #else
-#define debug(format, ...)                                                    \
-    {                                                                         \
-        char buffer[1024];                                                    \
-        snprintf(buffer, sizeof(buffer), "[WINCTRL] " format, ##__VA_ARGS__); \
-        if (AppState::getInstance()->debuggingEnabled) {                      \
-            XPLMDebugString(buffer);                                          \
-        }                                                                     \
-    }
-#define debug_force(format, ...)                                              \
-    {                                                                         \
-        char buffer[1024];                                                    \
-        snprintf(buffer, sizeof(buffer), "[WINCTRL] " format, ##__VA_ARGS__); \
-        XPLMDebugString(buffer);                                              \
+#define debug(format, ...)                                                   \
+    {                                                                        \
+        if (AppState::getInstance()->debuggingEnabled) {                     \
+            Logger::getInstance()->log("[WINCTRL] " format, ##__VA_ARGS__); \
+        }                                                                    \
     }
 #endif
+#define debug_force(format, ...)                                         \
+    {                                                                    \
+        Logger::getInstance()->log("[WINCTRL] " format, ##__VA_ARGS__); \
+    }
 
 #define PRODUCT_NAME "winctrl"
 #define FRIENDLY_NAME "WINCTRL"
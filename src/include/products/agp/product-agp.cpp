@@ -3,7 +3,9 @@
 #include "appstate.h"
 #include "config.h"
 #include "dataref.h"
+#include "display-model.h"
 #include "plugins-menu.h"
+#include "preferences.h"
 #include "profiles/toliss-agp-profile.h"
 #include "segment-display.h"
 
@@ -12,7 +14,16 @@
 #include <unordered_map>
 #include <XPLMUtilities.h>
 
-ProductAGP::ProductAGP(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName) : USBDevice(hidDevice, vendorId, productId, vendorName, productName) {
+// The three fields share one LCD packet
+static constexpr uint32_t LCDRegion = 1;
+
+static constexpr DisplayModel<AGPDisplayData, 3>::Fields displayFields = {
+    displayField<AGPDisplayData, &AGPDisplayData::chrono>(LCDRegion),
+    displayField<AGPDisplayData, &AGPDisplayData::utcTime>(LCDRegion),
+    displayField<AGPDisplayData, &AGPDisplayData::elapsedTime>(LCDRegion),
+};
+
+ProductAGP::ProductAGP(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName) : USBDevice(hidDevice, vendorId, productId, vendorName, productName), displayModel(displayFields) {
     lastButtonStateLo = 0;
     lastButtonStateHi = 0;
     pressedButtonIndices = {};
@@ -21,6 +32,7 @@ ProductAGP::ProductAGP(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t pr
 }
 
 ProductAGP::~ProductAGP() {
+    Preferences::getInstance()->removeObservers(this);
     blackout();
 
     PluginsMenu::getInstance()->removeItem(menuItemId);
@@ -35,14 +47,41 @@ const char *ProductAGP::classIdentifier() {
     return "AGP Metal";
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductAGP, AGPAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<TolissAGPProfile>("Toliss"),
+};
+
 void ProductAGP::setProfileForCurrentAircraft() {
-    if (TolissAGPProfile::IsEligible()) {
-        profile = new TolissAGPProfile(this);
-        profileReady = true;
-    } else {
-        profile = nullptr;
-        profileReady = false;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
+    }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+}
+
+void ProductAGP::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
     }
+
+    delete profile;
+    profile = nullptr;
+
+    setAllLedsEnabled(false);
 }
 
 bool ProductAGP::connect() {
@@ -55,14 +94,17 @@ bool ProductAGP::connect() {
     setLedBrightness(AGPLed::OVERALL_LEDS_BRIGHTNESS, 255);
     setAllLedsEnabled(false);
 
+    // Forget what the LCD showed so the next update is sent in full
+    displayModel.reset({});
+
     setProfileForCurrentAircraft();
 
     std::string terrainPreference = AppState::getInstance()->readPreference("AGPTerrainND", "first_officer");
-    if (terrainPreference == "captain") {
-        terrainNDPreference = AGPTerrainNDPreference::CAPTAIN;
-    } else {
-        terrainNDPreference = AGPTerrainNDPreference::FIRST_OFFICER;
-    }
+    terrainNDPreference = terrainPreference == "captain" ? AGPTerrainNDPreference::CAPTAIN : AGPTerrainNDPreference::FIRST_OFFICER;
+
+    Preferences::getInstance()->observe(this, "AGPTerrainND", [this](const std::string &value) {
+        terrainNDPreference = value == "captain" ? AGPTerrainNDPreference::CAPTAIN : AGPTerrainNDPreference::FIRST_OFFICER;
+    });
 
     menuItemId = PluginsMenu::getInstance()->addItem(
         classIdentifier(),
@@ -80,13 +122,11 @@ bool ProductAGP::connect() {
             {.name = "Terrain on ND", .content = std::vector<MenuItem>{
                                           {.name = "ND1 (Captain)", .checked = terrainPreference == "captain", .content = [this](int itemId) {
                                                AppState::getInstance()->writePreference("AGPTerrainND", "captain");
-                                               terrainNDPreference = AGPTerrainNDPreference::CAPTAIN;
                                                PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                                PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                            }},
                                           {.name = "ND2 (First officer)", .checked = terrainPreference == "first_officer", .content = [this](int itemId) {
                                                AppState::getInstance()->writePreference("AGPTerrainND", "first_officer");
-                                               terrainNDPreference = AGPTerrainNDPreference::FIRST_OFFICER;
                                                PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                                PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                            }},
@@ -104,20 +144,17 @@ void ProductAGP::blackout() {
     setAllLedsEnabled(false);
 }
 
-void ProductAGP::update() {
+void ProductAGP::render() {
     if (!connected) {
         return;
     }
 
-    USBDevice::update();
-
-    if (++displayUpdateFrameCounter >= getDisplayUpdateFrameInterval(12)) {
-        displayUpdateFrameCounter = 0;
-
-        if (profile) {
-            profile->updateDisplays();
-        }
+    if (!profile || getDisplayRefreshBackoff() > 1) {
+        return;
     }
+
+    // The profile renders when the next clock digit is due or a clock input changed, so it is cheap to ask every frame
+    profile->updateDisplays();
 }
 
 void ProductAGP::setAllLedsEnabled(bool enable) {
@@ -186,6 +223,19 @@ void ProductAGP::parseSegment(const std::string &text, int expectedLength, std::
 }
 
 void ProductAGP::setLCDText(const std::string &chrono, const std::string &utcTime, const std::string &elapsedTime) {
+    AGPDisplayData &text = displayModel.edit();
+    text.chrono = chrono;
+    text.utcTime = utcTime;
+    text.elapsedTime = elapsedTime;
+
+    bool changed = displayModel.commit() & LCDRegion;
+    displayModel.clearDirty();
+    if (!changed) {
+        return;
+    }
+
+    latency.markRender();
+
     std::vector<uint8_t> packet = {
         0xF0, 0x00, packetNumber, 0x35, ProductAGP::IdentifierByte,
         0xBB, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
@@ -1,10 +1,13 @@
 #ifndef PRODUCT_AGP_H
 #define PRODUCT_AGP_H
 
+#include "aircraft-detector.h"
 #include "agp-aircraft-profile.h"
+#include "display-model.h"
 #include "usbdevice.h"
 
 #include <set>
+#include <string>
 
 enum class AGPLed : int {
     BACKLIGHT = 0,
@@ -36,17 +39,23 @@ enum class AGPTerrainNDPreference {
     FIRST_OFFICER
 };
 
+struct AGPDisplayData {
+        std::string chrono;
+        std::string utcTime;
+        std::string elapsedTime;
+};
+
 class ProductAGP : public USBDevice {
     private:
-        AGPAircraftProfile *profile;
+        AGPAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductAGP, AGPAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
-        int displayUpdateFrameCounter = 0;
         uint64_t lastButtonStateLo;
         uint32_t lastButtonStateHi;
         std::set<int> pressedButtonIndices;
         uint8_t packetNumber = 1;
+        DisplayModel<AGPDisplayData, 3> displayModel;
 
-        void setProfileForCurrentAircraft();
         void parseSegment(const std::string &text, int expectedLength, std::string &outDigits, uint16_t &colonMask, int digitOffset);
 
     public:
@@ -59,7 +68,9 @@ class ProductAGP : public USBDevice {
 
         const char *classIdentifier() override;
         bool connect() override;
-        void update() override;
+        void render() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
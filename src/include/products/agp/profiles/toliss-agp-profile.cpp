@@ -1,5 +1,6 @@
 #include "toliss-agp-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-agp.h"
@@ -7,6 +8,20 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <XPLMProcessing.h>
+
+// Clock inputs that change what is shown independently of the running seconds
+static const std::vector<const char *> clockInputDatarefs = {
+    "AirbusFBW/ChronoButtonAnimations",
+    "AirbusFBW/ClockShowsET",
+    "AirbusFBW/ClockETHours",
+    "AirbusFBW/ClockETMinutes",
+    "sim/time/local_date_days",
+    "AirbusFBW/AnnunMode",
+    "AirbusFBW/FCUAvail",
+    "sim/cockpit/electrical/avionics_on",
+};
 
 TolissAGPProfile::TolissAGPProfile(ProductAGP *product) : AGPAircraftProfile(product) {
     Dataref::getInstance()->monitorExistingDataref<float>("AirbusFBW/PanelBrightnessLevel", [product](float brightness) {
@@ -85,7 +100,7 @@ TolissAGPProfile::~TolissAGPProfile() {
 }
 
 bool TolissAGPProfile::IsEligible() {
-    return Dataref::getInstance()->exists("AirbusFBW/PanelBrightnessLevel");
+    return AircraftDetector::getInstance()->hasDataref("AirbusFBW/PanelBrightnessLevel");
 }
 
 const std::unordered_map<uint16_t, AGPButtonDef> &TolissAGPProfile::buttonDefs() const {
@@ -147,6 +162,22 @@ void TolissAGPProfile::buttonPressed(const AGPButtonDef *button, XPLMCommandPhas
     }
 }
 
+bool TolissAGPProfile::isDisplayDue(double zuluTime, int chronoSecond) {
+    // The UTC and chrono seconds are the only digits that change on their own
+    if (zuluTime >= nextZuluDeadline || zuluTime < lastZuluTime || chronoSecond != lastChronoSecond) {
+        return true;
+    }
+
+    auto datarefManager = Dataref::getInstance();
+    for (const char *ref : clockInputDatarefs) {
+        if (datarefManager->getCachedLastUpdate(ref) > lastRenderCycle) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void TolissAGPProfile::updateDisplays() {
     if (!product) {
         return;
@@ -154,21 +185,32 @@ void TolissAGPProfile::updateDisplays() {
 
     auto datarefManager = Dataref::getInstance();
 
+    double zuluTime = datarefManager->getCached<double>("sim/time/zulu_time_sec");
+    float chronoSeconds = datarefManager->getCached<float>("AirbusFBW/ClockChronoValue");
+    int chronoSecond = chronoSeconds > std::numeric_limits<float>::epsilon() ? static_cast<int>(std::floor(chronoSeconds)) : -1;
+    if (!isDisplayDue(zuluTime, chronoSecond)) {
+        return;
+    }
+
+    lastRenderCycle = XPLMGetCycleNumber();
+    lastZuluTime = zuluTime;
+    lastChronoSecond = chronoSecond;
+
     std::string chrono = "";
-    float chronoSeconds = datarefManager->get<float>("AirbusFBW/ClockChronoValue");
-    if (chronoSeconds > std::numeric_limits<float>::epsilon()) {
-        int totalSeconds = static_cast<int>(std::floor(chronoSeconds));
-        int mins = totalSeconds / 60;
-        int secs = totalSeconds % 60;
+    if (chronoSecond >= 0) {
+        int mins = chronoSecond / 60;
+        int secs = chronoSecond % 60;
         chrono = SegmentDisplay::fixStringLength(std::to_string(mins), 2) + ":" +
                  SegmentDisplay::fixStringLength(std::to_string(secs), 2);
     }
 
     std::string utc = "";
-    std::vector<float> buttonAnimations = datarefManager->get<std::vector<float>>("AirbusFBW/ChronoButtonAnimations");
+    std::vector<float> buttonAnimations = datarefManager->getCached<std::vector<float>>("AirbusFBW/ChronoButtonAnimations");
     bool dateButtonPressed = buttonAnimations.size() > 2 && buttonAnimations[2] > std::numeric_limits<float>::epsilon();
     if (dateButtonPressed) {
-        int dayOfYear = datarefManager->get<int>("sim/time/local_date_days") + 1;
+        // The date only changes with local_date_days, which is watched as an input
+        nextZuluDeadline = std::numeric_limits<double>::infinity();
+        int dayOfYear = datarefManager->getCached<int>("sim/time/local_date_days") + 1;
 
         auto now = std::chrono::system_clock::now();
         std::time_t time = std::chrono::system_clock::to_time_t(now);
@@ -197,7 +239,7 @@ void TolissAGPProfile::updateDisplays() {
               (day < 10 ? "0" : "") + std::to_string(day) + ":" +
               std::to_string(year % 100);
     } else {
-        double zuluTime = datarefManager->get<double>("sim/time/zulu_time_sec");
+        nextZuluDeadline = std::floor(zuluTime) + 1.0;
 
         // Convert zulu time in seconds to HH:MM:SS
         int hours = static_cast<int>(zuluTime / 3600) % 24;
@@ -210,9 +252,9 @@ void TolissAGPProfile::updateDisplays() {
     }
 
     std::string elapsedTime = "";
-    if (datarefManager->get<bool>("AirbusFBW/ClockShowsET")) {
-        int hours = datarefManager->get<int>("AirbusFBW/ClockETHours");
-        int minutes = datarefManager->get<int>("AirbusFBW/ClockETMinutes");
+    if (datarefManager->getCached<bool>("AirbusFBW/ClockShowsET")) {
+        int hours = datarefManager->getCached<int>("AirbusFBW/ClockETHours");
+        int minutes = datarefManager->getCached<int>("AirbusFBW/ClockETMinutes");
         elapsedTime = SegmentDisplay::fixStringLength(std::to_string(hours), 2) + ":" +
                       SegmentDisplay::fixStringLength(std::to_string(minutes), 2);
     }
@@ -227,5 +269,5 @@ void TolissAGPProfile::updateDisplays() {
 }
 
 bool TolissAGPProfile::isAnnunTest(bool allowEssentialBusPowerOnly) {
-    return Dataref::getInstance()->get<int>("AirbusFBW/AnnunMode") == 2 && (allowEssentialBusPowerOnly ? Dataref::getInstance()->get<bool>("AirbusFBW/FCUAvail") : Dataref::getInstance()->get<bool>("sim/cockpit/electrical/avionics_on"));
+    return Dataref::getInstance()->getCached<int>("AirbusFBW/AnnunMode") == 2 && (allowEssentialBusPowerOnly ? Dataref::getInstance()->getCached<bool>("AirbusFBW/FCUAvail") : Dataref::getInstance()->getCached<bool>("sim/cockpit/electrical/avionics_on"));
 }
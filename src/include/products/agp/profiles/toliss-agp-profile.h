@@ -7,7 +7,13 @@
 
 class TolissAGPProfile : public AGPAircraftProfile {
     private:
+        int lastRenderCycle = 0;
+        double lastZuluTime = 0.0;
+        double nextZuluDeadline = 0.0;
+        int lastChronoSecond = -1;
+
         bool isAnnunTest(bool allowEssentialBusPowerOnly = false);
+        bool isDisplayDue(double zuluTime, int chronoSecond);
 
     public:
         TolissAGPProfile(ProductAGP *product);
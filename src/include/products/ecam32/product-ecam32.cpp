@@ -31,14 +31,41 @@ const char *ProductECAM32::classIdentifier() {
     return "ECAM32";
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductECAM32, ECAM32AircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<TolissECAM32Profile>("Toliss"),
+};
+
 void ProductECAM32::setProfileForCurrentAircraft() {
-    if (TolissECAM32Profile::IsEligible()) {
-        profile = new TolissECAM32Profile(this);
-        profileReady = true;
-    } else {
-        profile = nullptr;
-        profileReady = false;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
+    }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+}
+
+void ProductECAM32::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
     }
+
+    delete profile;
+    profile = nullptr;
+
+    setAllLedsEnabled(false);
 }
 
 bool ProductECAM32::connect() {
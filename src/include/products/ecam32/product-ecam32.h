@@ -1,6 +1,7 @@
 #ifndef PRODUCT_ECAM32_H
 #define PRODUCT_ECAM32_H
 
+#include "aircraft-detector.h"
 #include "ecam32-aircraft-profile.h"
 #include "usbdevice.h"
 
@@ -32,14 +33,13 @@ enum class ECAM32Led : int {
 
 class ProductECAM32 : public USBDevice {
     private:
-        ECAM32AircraftProfile *profile;
+        ECAM32AircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductECAM32, ECAM32AircraftProfile> *profileEntry = nullptr;
         int menuItemId;
         uint64_t lastButtonStateLo;
         uint32_t lastButtonStateHi;
         std::set<int> pressedButtonIndices;
 
-        void setProfileForCurrentAircraft();
-
     public:
         ProductECAM32(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName);
         ~ProductECAM32();
@@ -48,6 +48,8 @@ class ProductECAM32 : public USBDevice {
 
         const char *classIdentifier() override;
         bool connect() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
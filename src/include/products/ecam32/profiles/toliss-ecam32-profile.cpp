@@ -1,5 +1,6 @@
 #include "toliss-ecam32-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-ecam32.h"
@@ -59,7 +60,7 @@ TolissECAM32Profile::~TolissECAM32Profile() {
 }
 
 bool TolissECAM32Profile::IsEligible() {
-    return Dataref::getInstance()->exists("AirbusFBW/PanelBrightnessLevel");
+    return AircraftDetector::getInstance()->hasDataref("AirbusFBW/PanelBrightnessLevel");
 }
 
 const std::unordered_map<uint16_t, ECAM32ButtonDef> &TolissECAM32Profile::buttonDefs() const {
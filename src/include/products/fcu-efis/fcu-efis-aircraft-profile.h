@@ -7,9 +7,7 @@
 #include <cmath>
 #include <cstdint>
 #include <functional>
-#include <iomanip>
 #include <map>
-#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -115,7 +113,7 @@ enum class FCUEfisLed : int {
 struct EfisDisplayValue {
         bool displayEnabled = true;
         bool displayTest = false;
-        std::string baro;
+        SegmentDisplay::Text<4> baro = {};
         bool unitIsInHg;
         bool isStd = false;
         bool showQfe = false;
@@ -129,17 +127,15 @@ struct EfisDisplayValue {
             isStd = false;
             int baroValue = static_cast<int>(std::round(inHgValue * (isBaroInHg ? 100.0f : 33.8639f)));
             unitIsInHg = isBaroInHg;
-            std::ostringstream oss;
-            oss << std::setw(4) << std::setfill(' ') << baroValue;
-            baro = oss.str();
+            SegmentDisplay::writeNumber(baro, baroValue, ' ');
         }
 };
 
 struct FCUDisplayData {
-        std::string speed;
-        std::string heading;
-        std::string altitude;
-        std::string verticalSpeed;
+        SegmentDisplay::Text<3> speed = {};
+        SegmentDisplay::Text<3> heading = {};
+        SegmentDisplay::Text<5> altitude = {};
+        SegmentDisplay::Text<4> verticalSpeed = {};
         EfisDisplayValue efisLeft;
         EfisDisplayValue efisRight;
 
@@ -167,22 +163,6 @@ struct FCUDisplayData {
         bool fpaIndication = false;
         bool fpaComma = false;
         bool vsSign = true; // true = positive (up), false = negative (down)
-
-        bool operator==(const FCUDisplayData &other) const {
-            return speed == other.speed &&
-                   heading == other.heading &&
-                   altitude == other.altitude &&
-                   verticalSpeed == other.verticalSpeed &&
-                   spdMach == other.spdMach &&
-                   hdgTrk == other.hdgTrk &&
-                   altManaged == other.altManaged &&
-                   spdManaged == other.spdManaged &&
-                   hdgManaged == other.hdgManaged &&
-                   vsMode == other.vsMode &&
-                   fpaMode == other.fpaMode &&
-                   displayEnabled == other.displayEnabled &&
-                   displayTest == other.displayTest;
-        }
 };
 
 class ProductFCUEfis;
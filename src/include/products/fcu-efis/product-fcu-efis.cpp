@@ -3,6 +3,7 @@
 #include "appstate.h"
 #include "config.h"
 #include "dataref.h"
+#include "display-model.h"
 #include "plugins-menu.h"
 #include "profiles/ff350-fcu-efis-profile.h"
 #include "profiles/ff767-fcu-efis-profile.h"
@@ -11,27 +12,64 @@
 #include "profiles/laminar737-fcu-efis-profile.h"
 #include "profiles/toliss-fcu-efis-profile.h"
 #include "profiles/jf146-fcu-efis-profile.h"
+#include "render-worker.h"
 #include "segment-display.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
-#include <iomanip>
-#include <sstream>
 #include <XPLMDataAccess.h>
 #include <XPLMDisplay.h>
 #include <XPLMProcessing.h>
 #include <XPLMUtilities.h>
 
-ProductFCUEfis::ProductFCUEfis(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName) : USBDevice(hidDevice, vendorId, productId, vendorName, productName) {
+template<auto Member>
+static constexpr DisplayField<FCUDisplayData> field(uint32_t regions) {
+    return displayField<FCUDisplayData, Member>(regions);
+}
+
+static constexpr auto displayFields = std::to_array<DisplayField<FCUDisplayData>>({
+    field<&FCUDisplayData::speed>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::heading>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::altitude>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::verticalSpeed>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::efisLeft>(FCU_DISPLAY_EFIS_LEFT),
+    field<&FCUDisplayData::efisRight>(FCU_DISPLAY_EFIS_RIGHT),
+    field<&FCUDisplayData::displayEnabled>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::displayTest>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::spdMach>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::hdgTrk>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::altManaged>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::spdManaged>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::hdgManaged>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::vsMode>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::fpaMode>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::latMode>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::altIndication>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::vsHorizontalLine>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::vsVerticalLine>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::lvlChange>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::lvlChangeLeft>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::lvlChangeRight>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::vsIndication>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::fpaIndication>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::fpaComma>(FCU_DISPLAY_FCU),
+    field<&FCUDisplayData::vsSign>(FCU_DISPLAY_FCU),
+});
+static_assert(displayFields.size() == ProductFCUEfis::DisplayFieldCount);
+
+ProductFCUEfis::ProductFCUEfis(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName) : USBDevice(hidDevice, vendorId, productId, vendorName, productName), displayModel(displayFields) {
     profile = nullptr;
-    displayData = {};
     lastUpdateCycle = 0;
     pressedButtonIndices = {};
+    AppState::getInstance()->registerRefresh(this, 30.0f, 20);
 
     connect();
 }
 
 ProductFCUEfis::~ProductFCUEfis() {
+    AppState::getInstance()->unregisterRefresh(this);
+    RenderWorker::getInstance()->waitForJobs(this);
     blackout();
 
     PluginsMenu::getInstance()->removeItem(menuItemId);
@@ -42,29 +80,48 @@ ProductFCUEfis::~ProductFCUEfis() {
     }
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductFCUEfis, FCUEfisAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<FF350FCUEfisProfile>("FlightFactor A350"),
+    ProfileEntry::make<TolissFCUEfisProfile>("Toliss"),
+    ProfileEntry::make<Laminar737FCUEfisProfile>("Laminar 737"),
+    ProfileEntry::make<LaminarFCUEfisProfile>("Laminar A330"),
+    ProfileEntry::make<FF777FCUEfisProfile>("FlightFactor 777"),
+    ProfileEntry::make<FF767FCUEfisProfile>("FlightFactor 767"),
+    ProfileEntry::make<JF146FCUEfisProfile>("JustFlight 146"),
+};
+
 void ProductFCUEfis::setProfileForCurrentAircraft() {
-    if (FF350FCUEfisProfile::IsEligible()) {
-        profile = new FF350FCUEfisProfile(this);
-        profileReady = true;
-    } else if (TolissFCUEfisProfile::IsEligible()) {
-        profile = new TolissFCUEfisProfile(this);
-        profileReady = true;
-    } else if (Laminar737FCUEfisProfile::IsEligible()) {
-        profile = new Laminar737FCUEfisProfile(this);
-        profileReady = true;
-    } else if (LaminarFCUEfisProfile::IsEligible()) {
-        profile = new LaminarFCUEfisProfile(this);
-        profileReady = true;
-    } else if (FF777FCUEfisProfile::IsEligible()) {
-        profile = new FF777FCUEfisProfile(this);
-        profileReady = true;
-    } else if (FF767FCUEfisProfile::IsEligible()) {
-        profile = new FF767FCUEfisProfile(this);
-        profileReady = true;
-    } else if (JF146FCUEfisProfile::IsEligible()) {
-        profile = new JF146FCUEfisProfile(this);
-        profileReady = true;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
     }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+}
+
+void ProductFCUEfis::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
+    }
+
+    delete profile;
+    profile = nullptr;
+
+    setAllLedsEnabled(false);
+    clearDisplays();
 }
 
 const char *ProductFCUEfis::classIdentifier() {
@@ -134,20 +191,16 @@ void ProductFCUEfis::blackout() {
     clearDisplays();
 }
 
-void ProductFCUEfis::update() {
+void ProductFCUEfis::render() {
     if (!connected) {
         return;
     }
 
     if (!profile) {
-        setProfileForCurrentAircraft();
         return;
     }
 
-    USBDevice::update();
-
-    if (++displayUpdateFrameCounter >= getDisplayUpdateFrameInterval()) {
-        displayUpdateFrameCounter = 0;
+    if (AppState::getInstance()->shouldRefresh(this, getDisplayRefreshBackoff())) {
         updateDisplays(false);
     }
 }
@@ -166,23 +219,34 @@ void ProductFCUEfis::updateDisplays(bool force) {
         return;
     }
 
-    // Save old display data for comparison
-    FCUDisplayData oldDisplayData = displayData;
-    profile->updateDisplayData(displayData);
+    profile->updateDisplayData(displayModel.edit());
+    latency.markRender();
 
-    // Update FCU display if data changed
-    if (displayData != oldDisplayData) {
-        sendFCUDisplay(displayData.speed, displayData.heading, displayData.altitude, displayData.verticalSpeed);
+    uint32_t regions = displayModel.commit();
+    displayModel.clearDirty();
+    if (!profile->hasEfisLeft()) {
+        regions &= ~FCU_DISPLAY_EFIS_LEFT;
     }
-
-    // Update EFIS Right display if data changed
-    if (profile->hasEfisRight() && displayData.efisRight != oldDisplayData.efisRight) {
-        sendEfisDisplayWithFlags(&displayData.efisRight, true);
+    if (!profile->hasEfisRight()) {
+        regions &= ~FCU_DISPLAY_EFIS_RIGHT;
     }
 
-    // Update EFIS Left display if data changed
-    if (profile->hasEfisLeft() && displayData.efisLeft != oldDisplayData.efisLeft) {
-        sendEfisDisplayWithFlags(&displayData.efisLeft, false);
+    // One render job per refresh encodes the changed modules, each module is queued as one transaction.
+    // The latency origin is taken here, the tracker's output state belongs to the main thread.
+    if (regions) {
+        RenderWorker::getInstance()->submit(this, [this, data = displayModel.value(), regions, changedAt = latency.outputOrigin()]() mutable {
+            if (regions & FCU_DISPLAY_FCU) {
+                sendFCUDisplay(data, changedAt);
+            }
+
+            if (regions & FCU_DISPLAY_EFIS_RIGHT) {
+                sendEfisDisplayWithFlags(&data.efisRight, true, changedAt);
+            }
+
+            if (regions & FCU_DISPLAY_EFIS_LEFT) {
+                sendEfisDisplayWithFlags(&data.efisLeft, false, changedAt);
+            }
+        });
     }
 
     if (shouldUpdate) {
@@ -198,9 +262,11 @@ void ProductFCUEfis::initializeDisplays() {
 }
 
 void ProductFCUEfis::clearDisplays() {
-    displayData = {
+    RenderWorker::getInstance()->waitForJobs(this);
+
+    displayModel.reset({
         .displayEnabled = false,
-    };
+    });
 
     sendFCUDisplay("", "", "", "");
 
@@ -212,96 +278,109 @@ void ProductFCUEfis::clearDisplays() {
 }
 
 void ProductFCUEfis::sendFCUDisplay(const std::string &speed, const std::string &heading, const std::string &altitude, const std::string &vs) {
-    // Encode strings to 7-segment data
-    auto speedData = SegmentDisplay::encodeString(3, SegmentDisplay::fixStringLength(speed, 3));
-    auto headingData = SegmentDisplay::encodeStringSwapped(3, SegmentDisplay::fixStringLength(heading, 3));
-    auto altitudeData = SegmentDisplay::encodeStringSwapped(5, SegmentDisplay::fixStringLength(altitude, 5));
-    auto vsData = SegmentDisplay::encodeStringSwapped(4, SegmentDisplay::fixStringLength(vs, 4));
+    FCUDisplayData data = displayModel.value();
+    SegmentDisplay::writeText(data.speed, speed);
+    SegmentDisplay::writeText(data.heading, heading);
+    SegmentDisplay::writeText(data.altitude, altitude);
+    SegmentDisplay::writeText(data.verticalSpeed, vs);
+    sendFCUDisplay(data);
+}
+
+void ProductFCUEfis::sendFCUDisplay(const FCUDisplayData &data, std::chrono::steady_clock::time_point changedAt) {
+    // Encode fields to 7-segment data
+    std::array<uint8_t, 3> speedData;
+    std::array<uint8_t, 4> headingData;
+    std::array<uint8_t, 6> altitudeData;
+    std::array<uint8_t, 5> vsData;
+    SegmentDisplay::encode(data.speed, speedData);
+    SegmentDisplay::encodeSwapped(data.heading, headingData);
+    SegmentDisplay::encodeSwapped(data.altitude, altitudeData);
+    SegmentDisplay::encodeSwapped(data.verticalSpeed, vsData);
 
     // Create flag bytes array
-    std::vector<uint8_t> flagBytes(17, 0);
+    std::array<uint8_t, 17> flagBytes = {};
 
     // Set flags based on display data
-    if (displayData.spdMach) {
+    if (data.spdMach) {
         flagBytes[static_cast<int>(DisplayByteIndex::H3)] |= 0x04;
     }
-    if (displayData.spdManaged) {
+    if (data.spdManaged) {
         flagBytes[static_cast<int>(DisplayByteIndex::H3)] |= 0x02;
     }
-    if (!displayData.spdMach) {
+    if (!data.spdMach) {
         flagBytes[static_cast<int>(DisplayByteIndex::H3)] |= 0x08; // SPD
     }
 
-    if (displayData.hdgTrk) {
+    if (data.hdgTrk) {
         flagBytes[static_cast<int>(DisplayByteIndex::H0)] |= 0x40; // TRK
     } else {
         flagBytes[static_cast<int>(DisplayByteIndex::H0)] |= 0x80; // HDG
     }
-    if (displayData.hdgManaged) {
+    if (data.hdgManaged) {
         flagBytes[static_cast<int>(DisplayByteIndex::H0)] |= 0x10;
     }
-    if (displayData.latMode) {
+    if (data.latMode) {
         flagBytes[static_cast<int>(DisplayByteIndex::H0)] |= 0x20; // LAT
     }
 
-    if (displayData.altIndication) {
+    if (data.altIndication) {
         flagBytes[static_cast<int>(DisplayByteIndex::A4)] |= 0x10; // ALT
     }
-    if (displayData.altManaged) {
+    if (data.altManaged) {
         flagBytes[static_cast<int>(DisplayByteIndex::V1)] |= 0x10;
     }
 
-    if (displayData.vsMode) {
+    if (data.vsMode) {
         flagBytes[static_cast<int>(DisplayByteIndex::A5)] |= 0x04; // V/S
     }
-    if (displayData.fpaMode) {
+    if (data.fpaMode) {
         flagBytes[static_cast<int>(DisplayByteIndex::A5)] |= 0x01; // FPA
     }
-    if (displayData.hdgTrk) {
+    if (data.hdgTrk) {
         flagBytes[static_cast<int>(DisplayByteIndex::A5)] |= 0x02; // TRK
     }
-    if (!displayData.hdgTrk) {
+    if (!data.hdgTrk) {
         flagBytes[static_cast<int>(DisplayByteIndex::A5)] |= 0x08; // HDG
     }
 
-    if (displayData.vsHorizontalLine) {
+    if (data.vsHorizontalLine) {
         flagBytes[static_cast<int>(DisplayByteIndex::A0)] |= 0x10;
     }
-    if (displayData.vsVerticalLine) {
+    if (data.vsVerticalLine) {
         flagBytes[static_cast<int>(DisplayByteIndex::V2)] |= 0x20; // Move to different bit
     }
-    if (displayData.lvlChange) {
+    if (data.lvlChange) {
         flagBytes[static_cast<int>(DisplayByteIndex::A2)] |= 0x10;
     }
-    if (displayData.lvlChangeLeft) {
+    if (data.lvlChangeLeft) {
         flagBytes[static_cast<int>(DisplayByteIndex::A3)] |= 0x10;
     }
-    if (displayData.lvlChangeRight) {
+    if (data.lvlChangeRight) {
         flagBytes[static_cast<int>(DisplayByteIndex::A1)] |= 0x10;
     }
 
-    if (displayData.vsIndication) {
+    if (data.vsIndication) {
         flagBytes[static_cast<int>(DisplayByteIndex::V0)] |= 0x40;
     }
-    if (displayData.fpaIndication) {
+    if (data.fpaIndication) {
         flagBytes[static_cast<int>(DisplayByteIndex::V0)] |= 0x80;
     }
-    if (displayData.fpaComma) {
+    if (data.fpaComma) {
         flagBytes[static_cast<int>(DisplayByteIndex::V3)] |= 0x10; // Decimal after 1st digit for X.XX format
     }
-    if (displayData.vsSign) {
+    if (data.vsSign) {
         flagBytes[static_cast<int>(DisplayByteIndex::V2)] |= 0x10; // VS sign: true = positive, false = negative (per Python impl)
     }
-    if (displayData.spdMach) { // Mach comma
+    if (data.spdMach) { // Mach comma
         flagBytes[static_cast<int>(DisplayByteIndex::S1)] |= 0x01;
     }
 
-    if (!displayData.displayEnabled || displayData.displayTest) {
-        std::fill(speedData.begin(), speedData.end(), displayData.displayTest ? 0xFF : 0);
-        std::fill(headingData.begin(), headingData.end(), displayData.displayTest ? 0xFF : 0);
-        std::fill(altitudeData.begin(), altitudeData.end(), displayData.displayTest ? 0xFF : 0);
-        std::fill(vsData.begin(), vsData.end(), displayData.displayTest ? 0xFF : 0);
-        std::fill(flagBytes.begin(), flagBytes.end(), displayData.displayTest ? 0xFF : 0);
+    if (!data.displayEnabled || data.displayTest) {
+        std::fill(speedData.begin(), speedData.end(), data.displayTest ? 0xFF : 0);
+        std::fill(headingData.begin(), headingData.end(), data.displayTest ? 0xFF : 0);
+        std::fill(altitudeData.begin(), altitudeData.end(), data.displayTest ? 0xFF : 0);
+        std::fill(vsData.begin(), vsData.end(), data.displayTest ? 0xFF : 0);
+        std::fill(flagBytes.begin(), flagBytes.end(), data.displayTest ? 0xFF : 0);
     }
 
     // First request - send display data
@@ -338,8 +417,6 @@ void ProductFCUEfis::sendFCUDisplay(const std::string &speed, const std::string
         packet.push_back(0x00);
     }
 
-    writeData(packet);
-
     // Second request - commit display data
     std::vector<uint8_t> commitPacket = {
         0xF0, 0x00, packetNumber, 0x11, ProductFCUEfis::FCUIdentifierByte, 0xBB, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0xFF, 0xFF, 0x02, 0x00};
@@ -349,14 +426,18 @@ void ProductFCUEfis::sendFCUDisplay(const std::string &speed, const std::string
         commitPacket.push_back(0x00);
     }
 
-    writeData(commitPacket);
+    // Replaces an FCU update that is still waiting in the write queue
+    std::vector<std::vector<uint8_t>> transaction;
+    transaction.push_back(std::move(packet));
+    transaction.push_back(std::move(commitPacket));
+    writeTransaction(ProductFCUEfis::FCUIdentifierByte, std::move(transaction), changedAt);
     if (++packetNumber == 0) {
         packetNumber = 1;
     }
 }
 
-void ProductFCUEfis::sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRightSide) {
-    std::vector<uint8_t> flagBytes(17, 0);
+void ProductFCUEfis::sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRightSide, std::chrono::steady_clock::time_point changedAt) {
+    std::array<uint8_t, 17> flagBytes = {};
     flagBytes[static_cast<int>(isRightSide ? DisplayByteIndex::EFISR_B0 : DisplayByteIndex::EFISL_B0)] |= data->isStd ? 0x00 : (data->showQfe ? 0x01 : 0x02);
     if (data->unitIsInHg) { // Show comma
         flagBytes[static_cast<int>(isRightSide ? DisplayByteIndex::EFISR_B2 : DisplayByteIndex::EFISL_B2)] |= 0x80;
@@ -367,7 +448,9 @@ void ProductFCUEfis::sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRig
         0xF0, 0x00, packetNumber, 0x1A, static_cast<uint8_t>(isRightSide ? ProductFCUEfis::EfisRightIdentifierByte : ProductFCUEfis::EfisLeftIdentifierByte), 0xBF, 0x00, 0x00, 0x02, 0x01, 0x00, 0x00, 0xFF, 0xFF, 0x1D, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
     // Add barometric data
-    auto baroData = SegmentDisplay::encodeStringEfis(4, SegmentDisplay::fixStringLength(data->isStd ? "STD " : data->baro, 4));
+    static constexpr SegmentDisplay::Text<4> stdText = {'S', 'T', 'D', ' '};
+    std::array<uint8_t, 4> baroData;
+    SegmentDisplay::encodeEfis(data->isStd ? stdText : data->baro, baroData);
 
     if (!data->displayEnabled) {
         packet.push_back(0x00);
@@ -395,13 +478,15 @@ void ProductFCUEfis::sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRig
         packet.push_back(0x00);
     }
 
-    writeData(packet);
-
     std::vector<uint8_t> commitPacket = {
         0xF0, 0x00, packetNumber, 0x11, static_cast<uint8_t>(isRightSide ? ProductFCUEfis::EfisRightIdentifierByte : ProductFCUEfis::EfisLeftIdentifierByte),
         0xBF, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0x4C, 0x0C, 0x1D, 0x00};
     commitPacket.resize(64, 0x00);
-    writeData(commitPacket);
+
+    std::vector<std::vector<uint8_t>> transaction;
+    transaction.push_back(std::move(packet));
+    transaction.push_back(std::move(commitPacket));
+    writeTransaction(isRightSide ? ProductFCUEfis::EfisRightIdentifierByte : ProductFCUEfis::EfisLeftIdentifierByte, std::move(transaction), changedAt);
     if (++packetNumber == 0) {
         packetNumber = 1;
     }
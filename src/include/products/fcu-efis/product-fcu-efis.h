@@ -1,28 +1,37 @@
 #ifndef PRODUCT_FCUEFIS_H
 #define PRODUCT_FCUEFIS_H
 
+#include "aircraft-detector.h"
+#include "display-model.h"
 #include "fcu-efis-aircraft-profile.h"
 #include "usbdevice.h"
 
 #include <map>
 #include <set>
 
+enum FCUEfisDisplayRegion : uint32_t {
+    FCU_DISPLAY_FCU = 1 << 0,
+    FCU_DISPLAY_EFIS_LEFT = 1 << 1,
+    FCU_DISPLAY_EFIS_RIGHT = 1 << 2,
+};
+
 class ProductFCUEfis : public USBDevice {
+    public:
+        static constexpr size_t DisplayFieldCount = 26;
+
     private:
         uint8_t packetNumber = 1;
-        FCUEfisAircraftProfile *profile;
+        FCUEfisAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductFCUEfis, FCUEfisAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
-        FCUDisplayData displayData;
+        DisplayModel<FCUDisplayData, DisplayFieldCount> displayModel;
         int lastUpdateCycle;
-        int displayUpdateFrameCounter = 0;
         std::set<int> pressedButtonIndices;
         std::map<std::string, int> selectorPositions;
 
         uint64_t lastButtonStateLo = 0;
         uint32_t lastButtonStateHi = 0;
 
-        void setProfileForCurrentAircraft();
-
     public:
         ProductFCUEfis(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName);
         ~ProductFCUEfis();
@@ -33,7 +42,9 @@ class ProductFCUEfis : public USBDevice {
 
         const char *classIdentifier() override;
         bool connect() override;
-        void update() override;
+        void render() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
@@ -47,7 +58,8 @@ class ProductFCUEfis : public USBDevice {
         void initializeDisplays();
         void clearDisplays();
         void sendFCUDisplay(const std::string &speed, const std::string &heading, const std::string &altitude, const std::string &vs);
-        void sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRightSide);
+        void sendFCUDisplay(const FCUDisplayData &data, std::chrono::steady_clock::time_point changedAt = {});
+        void sendEfisDisplayWithFlags(EfisDisplayValue *data, bool isRightSide, std::chrono::steady_clock::time_point changedAt = {});
 };
 
 #endif
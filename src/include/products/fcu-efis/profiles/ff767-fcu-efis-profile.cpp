@@ -1,5 +1,6 @@
 #include "ff767-fcu-efis-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fcu-efis.h"
@@ -225,8 +226,8 @@ FF767FCUEfisProfile::~FF767FCUEfisProfile() {
 }
 
 bool FF767FCUEfisProfile::IsEligible() {
-    return (Dataref::getInstance()->exists("1-sim/AP/cmd_C_Button") &&
-            !(Dataref::getInstance()->exists("1-sim/output/mcp/ok")));
+    return (AircraftDetector::getInstance()->hasDataref("1-sim/AP/cmd_C_Button") &&
+            !(AircraftDetector::getInstance()->hasDataref("1-sim/output/mcp/ok")));
 }
 
 const std::vector<std::string> &FF767FCUEfisProfile::displayDatarefs() const {
@@ -456,16 +457,14 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float speed = datarefManager->getCached<float>("1-sim/AP/dig3/spdSetting");
 
     if (speed > 0) {
-        std::stringstream ss;
         if (data.spdMach) {
             int machHundredths = static_cast<int>(std::round(speed * 100));
-            ss << std::setfill('0') << std::setw(3) << machHundredths;
+            SegmentDisplay::writeNumber(data.speed, machHundredths);
         } else {
-            ss << std::setfill('0') << std::setw(3) << static_cast<int>(speed);
+            SegmentDisplay::writeNumber(data.speed, static_cast<int>(speed));
         }
-        data.speed = ss.str();
     } else {
-        data.speed = "---";
+        SegmentDisplay::writeText(data.speed, "---");
     }
 
     data.spdManaged = false;
@@ -474,11 +473,9 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float heading = datarefManager->getCached<float>("1-sim/AP/hdgSetting");
     if (heading >= 0) {
         int hdgDisplay = static_cast<int>(heading) % 360;
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(3) << hdgDisplay;
-        data.heading = ss.str();
+        SegmentDisplay::writeNumber(data.heading, hdgDisplay);
     } else {
-        data.heading = "---";
+        SegmentDisplay::writeText(data.heading, "---");
     }
 
     data.hdgManaged = false;
@@ -491,11 +488,9 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     if (altitude > 0) {
         //int altInt = static_cast<int>(altitude);
         int altInt = static_cast<int>(std::round(altitude / 100.0f) * 100);
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(5) << altInt;
-        data.altitude = ss.str();
+        SegmentDisplay::writeNumber(data.altitude, altInt);
     } else {
-        data.altitude = "-----";
+        SegmentDisplay::writeText(data.altitude, "-----");
     }
 
     data.altManaged = false;
@@ -505,12 +500,10 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     data.vsMode = true;
     data.fpaMode = false;
 
-    std::stringstream ss;
     int vsInt = static_cast<int>(std::round(vs));
     int absVs = std::abs(vsInt);
 
-    ss << std::setfill('0') << std::setw(4) << absVs;
-    data.verticalSpeed = ss.str();
+    SegmentDisplay::writeNumber(data.verticalSpeed, absVs);
 
     data.vsSign = (vs >= 0);
     data.fpaComma = false;
@@ -533,7 +526,7 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
         EfisDisplayValue value = {
             .displayEnabled = data.displayEnabled,
             .displayTest = data.displayTest,
-            .baro = "",
+            .baro = {},
             .unitIsInHg = false,
             //.isStd = (isCaptain && isStdCaptain) || (!isCaptain && isStdFirstOfficer), // MCN
             .isStd = (isCaptain && isStdCapt) || (!isCaptain && isStdFoff), // MCN
@@ -544,7 +537,7 @@ void FF767FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
         } */
 
         if (value.isStd) {
-            value.baro = "STD";
+            SegmentDisplay::writeText(value.baro, "STD ");
             value.unitIsInHg = false;
         } else if (baroValue > 0) {
             value.setBaro(baroValue, !isBaroHpa);
@@ -1,5 +1,6 @@
 #include "ff777-fcu-efis-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fcu-efis.h"
@@ -203,8 +204,8 @@ FF777FCUEfisProfile::~FF777FCUEfisProfile() {
 
 bool FF777FCUEfisProfile::IsEligible() {
     // FF777 datarefs that don't exist on the FF767
-    return Dataref::getInstance()->exists("1-sim/ckpt/mcpApLButton/anim") &&
-           Dataref::getInstance()->exists("1-sim/output/mcp/ok");
+    return AircraftDetector::getInstance()->hasDataref("1-sim/ckpt/mcpApLButton/anim") &&
+           AircraftDetector::getInstance()->hasDataref("1-sim/output/mcp/ok");
 }
 
 const std::vector<std::string> &FF777FCUEfisProfile::displayDatarefs() const {
@@ -422,16 +423,14 @@ void FF777FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float speed = datarefManager->getCached<float>("1-sim/output/mcp/spd");
 
     if (speed > 0) {
-        std::stringstream ss;
         if (data.spdMach) {
             int machHundredths = static_cast<int>(std::round(speed * 100));
-            ss << std::setfill('0') << std::setw(3) << machHundredths;
+            SegmentDisplay::writeNumber(data.speed, machHundredths);
         } else {
-            ss << std::setfill('0') << std::setw(3) << static_cast<int>(speed);
+            SegmentDisplay::writeNumber(data.speed, static_cast<int>(speed));
         }
-        data.speed = ss.str();
     } else {
-        data.speed = "---";
+        SegmentDisplay::writeText(data.speed, "---");
     }
 
     data.spdManaged = false;
@@ -439,11 +438,9 @@ void FF777FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float heading = datarefManager->getCached<float>("1-sim/output/mcp/hdg");
     if (heading >= 0) {
         int hdgDisplay = static_cast<int>(heading) % 360;
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(3) << hdgDisplay;
-        data.heading = ss.str();
+        SegmentDisplay::writeNumber(data.heading, hdgDisplay);
     } else {
-        data.heading = "---";
+        SegmentDisplay::writeText(data.heading, "---");
     }
 
     data.hdgManaged = false;
@@ -452,11 +449,9 @@ void FF777FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float altitude = datarefManager->getCached<float>("1-sim/output/mcp/alt");
     if (altitude >= 0) {
         int altInt = static_cast<int>(altitude);
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(5) << altInt;
-        data.altitude = ss.str();
+        SegmentDisplay::writeNumber(data.altitude, altInt);
     } else {
-        data.altitude = "-----";
+        SegmentDisplay::writeText(data.altitude, "-----");
     }
 
     data.altManaged = false;
@@ -466,12 +461,10 @@ void FF777FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     data.vsMode = true;
     data.fpaMode = false;
 
-    std::stringstream ss;
     int vsInt = static_cast<int>(std::round(vs));
     int absVs = std::abs(vsInt);
 
-    ss << std::setfill('0') << std::setw(4) << absVs;
-    data.verticalSpeed = ss.str();
+    SegmentDisplay::writeNumber(data.verticalSpeed, absVs);
 
     data.vsSign = (vs >= 0);
     data.fpaComma = false;
@@ -490,7 +483,7 @@ void FF777FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
         EfisDisplayValue value = {
             .displayEnabled = data.displayEnabled,
             .displayTest = data.displayTest,
-            .baro = "",
+            .baro = {},
             .unitIsInHg = false,
             .isStd = (isCaptain && isStdCaptain) || (!isCaptain && isStdFirstOfficer),
         };
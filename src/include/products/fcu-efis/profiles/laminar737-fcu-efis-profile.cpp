@@ -1,5 +1,6 @@
 #include "laminar737-fcu-efis-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fcu-efis.h"
@@ -115,7 +116,7 @@ Laminar737FCUEfisProfile::~Laminar737FCUEfisProfile() {
 
 bool Laminar737FCUEfisProfile::IsEligible() {
     // Check if it's a 737 by looking for ICAO code
-    std::string icao = Dataref::getInstance()->get<std::string>("sim/aircraft/view/acf_ICAO");
+    const std::string &icao = AircraftDetector::getInstance()->signature().icao;
 
     // Check for 737 variants (B731, B732, B733, B734, B735, B736, B737, B738, B739, etc.)
     if (icao.starts_with("B73")) {
@@ -274,12 +275,12 @@ void Laminar737FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
 
     if (!hasPower) {
         // Clear all displays when no power
-        data.speed = {"", {}};
-        data.heading = {"", {}};
-        data.altitude = {"", {}};
-        data.verticalSpeed = {"", {}};
-        data.efisRight.baro = "";
-        data.efisLeft.baro = "";
+        data.speed = {};
+        data.heading = {};
+        data.altitude = {};
+        data.verticalSpeed = {};
+        data.efisRight.baro = {};
+        data.efisLeft.baro = {};
         return;
     }
 
@@ -289,42 +290,28 @@ void Laminar737FCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
 
     if (isMach) {
         // Display as Mach number (e.g., "0.78" -> ".78")
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(2) << speed;
-        std::string machStr = ss.str();
-        if (machStr[0] == '0') {
-            machStr = machStr.substr(1); // Remove leading 0
-        }
-        data.speed = {machStr, {}};
+        SegmentDisplay::writeFixed(data.speed, speed, 2);
         data.spdMach = true;
 
     } else {
         // Display as knots
-        std::ostringstream ss;
-        ss << static_cast<int>(speed);
-        data.speed = ss.str();
+        SegmentDisplay::writeNumber(data.speed, static_cast<int>(speed));
         data.spdMach = false;
     }
 
     // Heading display
     float heading = Dataref::getInstance()->getCached<float>("sim/cockpit/autopilot/heading_mag");
-    std::ostringstream headingSs;
-    headingSs << std::setw(3) << std::setfill('0') << static_cast<int>(heading);
-    data.heading = headingSs.str();
+    SegmentDisplay::writeNumber(data.heading, static_cast<int>(heading));
 
     // Altitude display
     float altitude = Dataref::getInstance()->getCached<float>("sim/cockpit/autopilot/altitude");
-    std::ostringstream altSs;
-    altSs << std::setw(5) << std::setfill('0') << static_cast<int>(altitude);
-    data.altitude = altSs.str();
+    SegmentDisplay::writeNumber(data.altitude, static_cast<int>(altitude));
 
     // Vertical speed display
     float vs = Dataref::getInstance()->getCached<float>("sim/cockpit/autopilot/vertical_velocity");
-    std::ostringstream vsSs;
     int vsInt = static_cast<int>(vs);
     int absVs = std::abs(vsInt);
-    vsSs << std::setw(4) << std::setfill('0') << absVs;
-    data.verticalSpeed = vsSs.str();
+    SegmentDisplay::writeNumber(data.verticalSpeed, absVs);
     data.vsSign = (vs >= 0);
     data.vsMode = true;
 
@@ -1,5 +1,6 @@
 #include "toliss-fcu-efis-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fcu-efis.h"
@@ -187,8 +188,8 @@ TolissFCUEfisProfile::~TolissFCUEfisProfile() {
 }
 
 bool TolissFCUEfisProfile::IsEligible() {
-    return ((Dataref::getInstance()->exists("AirbusFBW/FCUAvail")) &&
-            (Dataref::getInstance()->exists("AirbusFBW/NDrangeCapt"))); // exclude the FFA350
+    return ((AircraftDetector::getInstance()->hasDataref("AirbusFBW/FCUAvail")) &&
+            (AircraftDetector::getInstance()->hasDataref("AirbusFBW/NDrangeCapt"))); // exclude the FFA350
 }
 
 const std::vector<std::string> &TolissFCUEfisProfile::displayDatarefs() const {
@@ -343,18 +344,16 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     float speed = datarefManager->getCached<float>("sim/cockpit2/autopilot/airspeed_dial_kts_mach");
 
     if (speed > 0 && datarefManager->getCached<bool>("AirbusFBW/SPDdashed") == false) {
-        std::stringstream ss;
         if (data.spdMach) {
             // In Mach mode, format as 0.XX -> "0XX" (e.g., 0.40 -> "040", 0.82 -> "082")
             int machHundredths = static_cast<int>(std::round(speed * 100));
-            ss << std::setfill('0') << std::setw(3) << machHundredths;
+            SegmentDisplay::writeNumber(data.speed, machHundredths);
         } else {
             // In speed mode, format as regular integer
-            ss << std::setfill('0') << std::setw(3) << static_cast<int>(speed);
+            SegmentDisplay::writeNumber(data.speed, static_cast<int>(speed));
         }
-        data.speed = ss.str();
     } else {
-        data.speed = "---";
+        SegmentDisplay::writeText(data.speed, "---");
     }
 
     // Format FCU heading display
@@ -362,23 +361,19 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
     if (heading >= 0 && datarefManager->getCached<bool>("AirbusFBW/HDGdashed") == false) {
         // Convert 360 to 0 for display
         int hdgDisplay = static_cast<int>(heading) % 360;
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(3) << hdgDisplay;
-        data.heading = ss.str();
+        SegmentDisplay::writeNumber(data.heading, hdgDisplay);
     } else {
-        data.heading = "---";
+        SegmentDisplay::writeText(data.heading, "---");
     }
 
     // Format FCU altitude display
     float altitude = datarefManager->getCached<float>("toliss_airbus/pfdoutputs/general/ap_altitude_reference");
     if (altitude >= 0) {
         int altInt = static_cast<int>(altitude);
-        std::stringstream ss;
         // Always show full altitude value
-        ss << std::setfill('0') << std::setw(5) << altInt;
-        data.altitude = ss.str();
+        SegmentDisplay::writeNumber(data.altitude, altInt);
     } else {
-        data.altitude = "-----";
+        SegmentDisplay::writeText(data.altitude, "-----");
     }
 
     // Format vertical speed display
@@ -392,7 +387,7 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
 
     if (vsDashed) {
         // When dashed, show 5 dashes with minus sign
-        data.verticalSpeed = "-----";
+        SegmentDisplay::writeText(data.verticalSpeed, "-----");
         data.vsSign = false;          // Show minus sign for dashes
         data.fpaComma = data.fpaMode; // Show decimal point only in FPA mode
     } else if (data.fpaMode) {
@@ -411,27 +406,22 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
 
         int fpaTenths = static_cast<int>(std::round(absFpa * 10)); // 0.0->0, 0.6->6, 1.2->12, 2.5->25
 
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(2) << fpaTenths << "  "; // 2 digits + 2 spaces
-
-        data.verticalSpeed = ss.str();
+        SegmentDisplay::writeNumber(data.verticalSpeed, fpaTenths, '0', "  "); // 2 digits + 2 spaces
 
         data.fpaComma = true;     // Enable decimal point display
         data.vsSign = (fpa >= 0); // Control sign display for FPA
     } else {
         // Normal VS mode: Format with proper padding to 4 digits (no sign in string)
-        std::stringstream ss;
         int vsInt = static_cast<int>(std::round(vs));
         int absVs = std::abs(vsInt);
 
         // If VS is a multiple of 100, show last two digits as "##"
         if (absVs % 100 == 0) {
-            ss << std::setfill('0') << std::setw(2) << (absVs / 100) << "##";
+            SegmentDisplay::writeNumber(data.verticalSpeed, absVs / 100, '0', "##");
         } else {
             // Show full value for non-multiples of 100
-            ss << std::setfill('0') << std::setw(4) << absVs;
+            SegmentDisplay::writeNumber(data.verticalSpeed, absVs);
         }
-        data.verticalSpeed = ss.str();
 
         data.vsSign = (vs >= 0); // Control sign display for VS
         data.fpaComma = false;   // No decimal point in VS mode
@@ -443,7 +433,7 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
 
     // VS vertical line
     // Only show vertical line in VS mode when not dashed
-    data.vsVerticalLine = data.vsMode && (data.verticalSpeed != "-----");
+    data.vsVerticalLine = data.vsMode && !vsDashed;
 
     // LAT mode - Typically always on for Airbus
     data.latMode = true;
@@ -458,7 +448,7 @@ void TolissFCUEfisProfile::updateDisplayData(FCUDisplayData &data) {
         EfisDisplayValue value = {
             .displayEnabled = datarefManager->getCached<bool>("AirbusFBW/FCUAvail"),
             .displayTest = isAnnunTest(true),
-            .baro = "",
+            .baro = {},
             .unitIsInHg = false,
             .isStd = isStd,
         };
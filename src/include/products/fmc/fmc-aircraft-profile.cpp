@@ -0,0 +1,41 @@
+#include "fmc-aircraft-profile.h"
+
+#include "appstate.h"
+#include "config.h"
+
+#include <algorithm>
+#include <XPLMUtilities.h>
+
+const FMCEncodingTable &FMCAircraftProfile::encodingTable() {
+    if (encoding) {
+        return *encoding;
+    }
+
+    // colorMap() and mapCharacter() only depend on their arguments, so every value is encoded once per profile
+    encoding = std::make_unique<FMCEncodingTable>();
+    const std::map<char, FMCTextColor> &colors = colorMap();
+    std::vector<uint8_t> glyphBytes;
+
+    for (int fontSmall = 0; fontSmall < 2; ++fontSmall) {
+        for (int value = 0; value < 256; ++value) {
+            auto it = colors.find(static_cast<char>(value));
+            int color = it != colors.end() ? it->second : FMCTextColor::COLOR_WHITE;
+            if (fontSmall) {
+                color += 0x016b;
+            }
+            encoding->colors[fontSmall][value] = {static_cast<uint8_t>(color & 0xFF), static_cast<uint8_t>((color >> 8) & 0xFF)};
+
+            glyphBytes.clear();
+            mapCharacter(&glyphBytes, static_cast<uint8_t>(value), fontSmall);
+
+            FMCGlyphEncoding &glyph = encoding->glyphs[fontSmall][value];
+            if (glyphBytes.size() > glyph.bytes.size()) {
+                debug("Glyph 0x%02X encodes to %zu bytes, truncating to %zu\n", value, glyphBytes.size(), glyph.bytes.size());
+            }
+            glyph.length = static_cast<uint8_t>(std::min(glyphBytes.size(), glyph.bytes.size()));
+            std::copy_n(glyphBytes.begin(), glyph.length, glyph.bytes.begin());
+        }
+    }
+
+    return *encoding;
+}
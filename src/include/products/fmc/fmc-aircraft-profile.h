@@ -2,9 +2,11 @@
 #define FMC_AIRCRAFT_PROFILE_H
 
 #include "fmc-hardware-mapping.h"
+#include "fmc-page.h"
 
 #include <array>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <XPLMUtilities.h>
@@ -85,9 +87,38 @@ enum class FMCBackgroundVariant : unsigned char {
     WINCTRL_LOGO
 };
 
+enum class FMCLayoutKind : unsigned char {
+    Text,
+    Symbols,
+    Scratchpad,
+};
+
+// A display dataref resolved to its place on the page when the profile is created
+struct FMCLayoutEntry {
+        const char *dataref;
+        unsigned char line;
+        char color;
+        bool fontSmall;
+        FMCLayoutKind kind;
+};
+
+struct FMCGlyphEncoding {
+        uint8_t length = 0;
+        std::array<uint8_t, 3> bytes = {};
+};
+
+// Wire bytes for every color and glyph value, indexed by [fontSmall][value]
+struct FMCEncodingTable {
+        std::array<std::array<std::array<uint8_t, 2>, 256>, 2> colors = {};
+        std::array<std::array<FMCGlyphEncoding, 256>, 2> glyphs = {};
+};
+
 class ProductFMC;
 
 class FMCAircraftProfile {
+    private:
+        std::unique_ptr<FMCEncodingTable> encoding;
+
     protected:
         ProductFMC *product;
 
@@ -101,12 +132,14 @@ class FMCAircraftProfile {
         virtual const std::unordered_map<FMCKey, const FMCButtonDef *> &buttonKeyMap() const = 0;
         virtual const std::map<char, FMCTextColor> &colorMap() const = 0;
         virtual void mapCharacter(std::vector<uint8_t> *buffer, uint8_t character, bool isFontSmall) = 0;
-        virtual void updatePage(std::vector<std::vector<char>> &page) = 0;
+        virtual void updatePage(FMCPage &page) = 0;
         virtual void buttonPressed(const FMCButtonDef *button, XPLMCommandPhase phase) = 0;
 
         virtual bool shouldReadDatarefAsBytes(const std::string &dataref) const {
             return false;
         }
+
+        const FMCEncodingTable &encodingTable();
 };
 
 #endif
@@ -0,0 +1,46 @@
+#include "fmc-page.h"
+
+#include "appstate.h"
+#include "config.h"
+
+#include <algorithm>
+#include <XPLMUtilities.h>
+
+void FMCPage::clear() {
+    cells.fill(FMCCell{});
+}
+
+void FMCPage::writeCell(int line, int pos, char glyph, char color, bool fontSmall) {
+    if (line < 0 || line >= Lines || pos < 0 || pos >= CharsPerLine) {
+        debug("Not writing cell %i:%i: Position is out of range!\n", line, pos);
+        return;
+    }
+
+    cells[line * CharsPerLine + pos] = {.glyph = glyph, .color = color, .fontSmall = fontSmall};
+}
+
+void FMCPage::writeSpan(int line, int pos, std::string_view text, char color, bool fontSmall) {
+    if (line < 0 || line >= Lines) {
+        debug("Not writing line %i: Line number is out of range!\n", line);
+        return;
+    }
+    if (pos < 0 || pos + text.length() > CharsPerLine) {
+        debug("Not writing line %i: Position number (%i) is out of range!\n", line, pos);
+        return;
+    }
+
+    FMCCell *cell = &cells[line * CharsPerLine + pos];
+    for (char glyph : text) {
+        *cell++ = {.glyph = glyph, .color = color, .fontSmall = fontSmall};
+    }
+}
+
+std::bitset<FMCPage::Lines> FMCPage::dirtyRows(const FMCPage &other) const {
+    std::bitset<Lines> rows;
+    for (int line = 0; line < Lines; ++line) {
+        auto begin = cells.begin() + line * CharsPerLine;
+        rows[line] = !std::equal(begin, begin + CharsPerLine, other.cells.begin() + line * CharsPerLine);
+    }
+
+    return rows;
+}
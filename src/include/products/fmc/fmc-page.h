@@ -0,0 +1,37 @@
+#ifndef FMC_PAGE_H
+#define FMC_PAGE_H
+
+#include <array>
+#include <bitset>
+#include <string_view>
+
+struct FMCCell {
+        char glyph = ' ';
+        char color = 0;
+        bool fontSmall = false;
+
+        bool operator==(const FMCCell &other) const = default;
+};
+
+class FMCPage {
+    public:
+        static constexpr int Lines = 14; // Header + 6 * label + 6 * cont + textbox
+        static constexpr int CharsPerLine = 24;
+
+        void clear();
+        void writeCell(int line, int pos, char glyph, char color, bool fontSmall = false);
+        void writeSpan(int line, int pos, std::string_view text, char color, bool fontSmall = false);
+
+        const FMCCell &at(int line, int pos) const {
+            return cells[line * CharsPerLine + pos];
+        }
+
+        std::bitset<Lines> dirtyRows(const FMCPage &other) const;
+
+        bool operator==(const FMCPage &other) const = default;
+
+    private:
+        std::array<FMCCell, Lines * CharsPerLine> cells = {};
+};
+
+#endif
@@ -9,80 +9,233 @@
 #include "vga_1.h"
 #include "xcrafts.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <filesystem>
-#include <fstream>
+#include <functional>
 #include <XPLMUtilities.h>
 
-const std::vector<std::vector<unsigned char>> Font::GlyphData(std::string filename, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
-    std::string pluginDir = AppState::getInstance()->getPluginDirectory();
-    if (pluginDir.empty()) {
-        debug_force("Plugin directory is empty\n");
-        return {};
+#if IBM
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::map<std::string, std::shared_ptr<const FontData>> Font::cache = {};
+
+static bool mapFontFile(const std::filesystem::path &path, const std::function<void(const unsigned char *data, size_t size)> &reader) {
+#if IBM
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
     }
 
-    std::filesystem::path fontFile = std::filesystem::path(pluginDir) / "fonts" / filename;
-    std::ifstream file(fontFile, std::ios::binary);
-    if (!file) {
-        debug_force("Could not open custom font file: %s\n", fontFile.c_str());
-        return {};
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
     }
 
-    std::vector<std::vector<unsigned char>> result = {};
-    unsigned char lengthByte = 0;
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
 
-    while (file.read(reinterpret_cast<char *>(&lengthByte), sizeof(lengthByte))) {
-        if (lengthByte == 0) {
-            break;
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view) {
+        reader(static_cast<const unsigned char *>(view), static_cast<size_t>(size.QuadPart));
+        UnmapViewOfFile(view);
+    }
+
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return view != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    reader(static_cast<const unsigned char *>(view), size);
+    munmap(view, size);
+    return true;
+#endif
+}
+
+// Hashes what a glyph block draws. Sequence numbers and the per-capture record ids differ between
+// fonts even for identical glyphs, so they are left out.
+static uint64_t glyphHash(const std::vector<std::vector<unsigned char>> &packets, const FontGlyph &glyph) {
+    std::vector<unsigned char> content = {};
+    for (size_t p = glyph.firstPacket; p < glyph.firstPacket + glyph.packetCount; p++) {
+        const auto &packet = packets[p];
+        if (packet.size() < 4 || packet[0] != 0xF0) {
+            content.insert(content.end(), packet.begin(), packet.end());
+        } else if (packet[1] == 0x00) {
+            size_t length = std::min<size_t>(packet[3], packet.size() - 4);
+            content.insert(content.end(), packet.begin() + 4, packet.begin() + 4 + length);
         }
+    }
 
-        std::vector<unsigned char> glyphData(lengthByte, 0);
-        if (file.read(reinterpret_cast<char *>(glyphData.data()), lengthByte)) {
-            result.push_back(glyphData);
-        } else {
-            debug_force("Failed to read glyph data from file: %s\n", fontFile.c_str());
+    // Records start with <identifier> BB 00 00 <command> 01 00 00 <record id>
+    for (size_t i = 0; i + 12 <= content.size(); i++) {
+        if (content[i + 1] == 0xBB && content[i + 2] == 0x00 && content[i + 3] == 0x00 && content[i + 5] == 0x01 && content[i + 6] == 0x00 && content[i + 7] == 0x00) {
+            std::fill(content.begin() + i + 8, content.begin() + i + 12, 0x00);
+        }
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : content) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+std::shared_ptr<const FontData> Font::Build(const unsigned char *data, size_t size, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
+    auto font = std::make_shared<FontData>();
+
+    // Length prefixed glyph packets, a zero length ends the font
+    size_t offset = 0;
+    while (offset < size && data[offset] != 0) {
+        size_t length = data[offset];
+        if (offset + 1 + length > size) {
+            debug_force("Font data is truncated at offset %zu\n", offset);
             break;
         }
+
+        font->packets.emplace_back(data + offset + 1, data + offset + 1 + length);
+        offset += 1 + length;
     }
 
-    convertGlyphDataForHardware(result, hardwareIdentifier, hardwareType);
+    convertGlyphDataForHardware(font->packets, hardwareIdentifier, hardwareType);
 
-    return result;
+    // Each glyph block is uploaded as a run of data packets (F0 00) closed by commit packets (F0 01),
+    // other packets are kept as blocks of their own so they are never dropped from a delta.
+    auto packetKind = [](const std::vector<unsigned char> &packet) {
+        return packet.size() < 2 || packet[0] != 0xF0 ? 2 : packet[1];
+    };
+
+    uint64_t fontHash = 14695981039346656037ull;
+    for (size_t i = 0; i < font->packets.size(); i++) {
+        const auto &packet = font->packets[i];
+        int kind = packetKind(packet);
+        int previousKind = i > 0 ? packetKind(font->packets[i - 1]) : 2;
+        if (i == 0 || kind == 2 || previousKind == 2 || (kind == 0 && previousKind == 1)) {
+            font->glyphs.push_back({.firstPacket = i, .packetCount = 0, .hash = 0});
+        }
+        font->glyphs.back().packetCount++;
+
+        fontHash = (fontHash ^ packet.size()) * 1099511628211ull;
+        for (unsigned char byte : packet) {
+            fontHash = (fontHash ^ byte) * 1099511628211ull;
+        }
+    }
+
+    for (auto &glyph : font->glyphs) {
+        glyph.hash = glyphHash(font->packets, glyph);
+    }
+    font->hash = fontHash;
+
+    return font;
+}
+
+std::shared_ptr<const FontData> Font::GlyphData(std::string filename, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
+    std::string pluginDir = AppState::getInstance()->getPluginDirectory();
+    if (pluginDir.empty()) {
+        debug_force("Plugin directory is empty\n");
+        return nullptr;
+    }
+
+    std::filesystem::path fontFile = std::filesystem::path(pluginDir) / "fonts" / filename;
+
+    // Include the modification time so an edited font file is picked up again
+    std::error_code error;
+    auto modifiedAt = std::filesystem::last_write_time(fontFile, error);
+    std::string key = "file:" + filename + ":" + std::to_string(error ? 0 : modifiedAt.time_since_epoch().count()) + ":" + std::to_string(hardwareIdentifier) + ":" + std::to_string(static_cast<int>(hardwareType));
+
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<const FontData> font = nullptr;
+    bool mapped = mapFontFile(fontFile, [&](const unsigned char *data, size_t size) {
+        font = Build(data, size, hardwareIdentifier, hardwareType);
+    });
+
+    if (!mapped || !font) {
+        debug_force("Could not open custom font file: %s\n", fontFile.string().c_str());
+        return nullptr;
+    }
+
+    cache[key] = font;
+    return font;
 }
 
-const std::vector<std::vector<unsigned char>> Font::GlyphData(FontVariant variant, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
-    std::vector<std::vector<unsigned char>> result = {};
+std::shared_ptr<const FontData> Font::GlyphData(FontVariant variant, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
+    std::string key = "builtin:" + std::to_string(static_cast<int>(variant)) + ":" + std::to_string(hardwareIdentifier) + ":" + std::to_string(static_cast<int>(hardwareType));
+
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    const unsigned char *data = nullptr;
+    size_t size = 0;
 
     switch (variant) {
         case FontVariant::FontAirbus:
-            result = fmcFontAirbus;
+            data = fmcFontAirbus;
+            size = sizeof(fmcFontAirbus);
             break;
 
         case FontVariant::Font737:
-            result = fmcFont737;
+            data = fmcFont737;
+            size = sizeof(fmcFont737);
             break;
 
         case FontVariant::FontXCrafts:
-            result = fmcFontXCrafts;
+            data = fmcFontXCrafts;
+            size = sizeof(fmcFontXCrafts);
             break;
 
         case FontVariant::FontVGA1:
-            result = fmcFontVGA1;
+            data = fmcFontVGA1;
+            size = sizeof(fmcFontVGA1);
             break;
 
         case FontVariant::FontMD11:
-            result = fmcFontMd11Cdu;
+            data = fmcFontMd11Cdu;
+            size = sizeof(fmcFontMd11Cdu);
             break;
 
         case FontVariant::Default:
         default:
-            result = fmcFontDefault;
+            data = fmcFontDefault;
+            size = sizeof(fmcFontDefault);
             break;
     }
 
-    convertGlyphDataForHardware(result, hardwareIdentifier, hardwareType);
-
-    return result;
+    auto font = Build(data, size, hardwareIdentifier, hardwareType);
+    cache[key] = font;
+    return font;
 }
 
 const std::vector<std::string> Font::ReadCustomFontFiles() {
@@ -123,6 +276,31 @@ const bool Font::IsCustomFontAvailable(std::string filename) {
     return false;
 }
 
+std::vector<const std::vector<unsigned char> *> Font::Delta(const FontData *loaded, const FontData &target) {
+    std::vector<const std::vector<unsigned char> *> result = {};
+    if (loaded && loaded->hash == target.hash) {
+        return result;
+    }
+
+    // Glyph blocks are compared by position, a font with a different layout is sent in full
+    bool fullUpload = !loaded || loaded->glyphs.size() != target.glyphs.size();
+    for (size_t i = 0; i < target.glyphs.size(); i++) {
+        const auto &glyph = target.glyphs[i];
+
+        // The first and last blocks carry the upload start and finish records
+        bool isBoundary = i == 0 || i == target.glyphs.size() - 1;
+        if (!fullUpload && !isBoundary && loaded->glyphs[i].hash == glyph.hash) {
+            continue;
+        }
+
+        for (size_t p = glyph.firstPacket; p < glyph.firstPacket + glyph.packetCount; p++) {
+            result.push_back(&target.packets[p]);
+        }
+    }
+
+    return result;
+}
+
 void Font::convertGlyphDataForHardware(std::vector<std::vector<unsigned char>> &data, unsigned char hardwareIdentifier, FMCHardwareType hardwareType) {
     for (auto &row : data) {
         for (size_t i = 0; i + 1 < row.size(); i++) {
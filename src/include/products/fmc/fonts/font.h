@@ -3,7 +3,12 @@
 
 #include "fmc-hardware-mapping.h"
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
+
 enum class FontVariant : unsigned char {
     Default,
     FontAirbus,
@@ -13,15 +18,34 @@ enum class FontVariant : unsigned char {
     FontMD11,
 };
 
+struct FontGlyph {
+        size_t firstPacket;
+        size_t packetCount;
+        uint64_t hash;
+};
+
+struct FontData {
+        std::vector<std::vector<unsigned char>> packets;
+        std::vector<FontGlyph> glyphs;
+        uint64_t hash = 0;
+};
+
 class Font {
     private:
+        // Hardware converted fonts, keyed by font, hardware identifier and hardware type
+        static std::map<std::string, std::shared_ptr<const FontData>> cache;
+
+        static std::shared_ptr<const FontData> Build(const unsigned char *data, size_t size, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
         static void convertGlyphDataForHardware(std::vector<std::vector<unsigned char>> &data, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
 
     public:
-        static const std::vector<std::vector<unsigned char>> GlyphData(std::string filename, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
-        static const std::vector<std::vector<unsigned char>> GlyphData(FontVariant variant, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
+        static std::shared_ptr<const FontData> GlyphData(std::string filename, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
+        static std::shared_ptr<const FontData> GlyphData(FontVariant variant, unsigned char hardwareIdentifier, FMCHardwareType hardwareType);
         static const std::vector<std::string> ReadCustomFontFiles();
         static const bool IsCustomFontAvailable(std::string filename);
+
+        // Packets that turn the font loaded on a device into the target font, only glyphs that differ are included
+        static std::vector<const std::vector<unsigned char> *> Delta(const FontData *loaded, const FontData &target);
 };
 
 #endif
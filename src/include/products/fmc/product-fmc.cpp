@@ -13,26 +13,31 @@
 #include "profiles/toliss-fmc-profile.h"
 #include "profiles/xcrafts-fmc-profile.h"
 #include "profiles/zibo-fmc-profile.h"
+#include "render-worker.h"
 #include "usbcontroller.h"
 
 #include <chrono>
 #include <XPLMProcessing.h>
 
+std::map<std::pair<const AircraftProfileEntry<ProductFMC, FMCAircraftProfile> *, FMCDeviceVariant>, std::shared_ptr<FMCRenderedFrame>> ProductFMC::renderCache;
+uint64_t ProductFMC::renderGeneration = 0;
+
 ProductFMC::ProductFMC(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName, FMCHardwareType hardwareType, FMCDeviceVariant variant, unsigned char identifierByte) : USBDevice(hidDevice, vendorId, productId, vendorName, productName), hardwareType(hardwareType), identifierByte(identifierByte), deviceVariant(variant) {
     profile = nullptr;
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageBytesPerLine, ' '));
-    lastUpdateCycle = 0;
     lastButtonStateLo = 0;
     lastButtonStateHi = 0;
     menuItemId = -1;
     fontsMenuItemId = -1;
 
     pressedButtonIndices = {};
+    AppState::getInstance()->registerRefresh(this, 15.0f, 40);
 
     connect();
 }
 
 ProductFMC::~ProductFMC() {
+    AppState::getInstance()->unregisterRefresh(this);
+    RenderWorker::getInstance()->waitForJobs(this);
     blackout();
     if (fontsMenuItemId >= 0) {
         PluginsMenu::getInstance()->removeItem(fontsMenuItemId);
@@ -41,47 +46,43 @@ ProductFMC::~ProductFMC() {
     if (menuItemId >= 0) {
         PluginsMenu::getInstance()->removeItem(menuItemId);
     }
-    unloadProfile();
+
+    if (profile) {
+        delete profile;
+        profile = nullptr;
+    }
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductFMC, FMCAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<TolissFMCProfile>("Toliss"),
+    ProfileEntry::make<LaminarFMCProfile>("Laminar A330"),
+    ProfileEntry::make<XCraftsFMCProfile>("X-Crafts"),
+    ProfileEntry::make<ZiboFMCProfile>("Zibo 737"),
+    ProfileEntry::make<RotateMD11FMCProfile>("Rotate MD-11"),
+    ProfileEntry::make<FlightFactor767FMCProfile>("FlightFactor 767"),
+    ProfileEntry::make<FlightFactor777FMCProfile>("FlightFactor 777"),
+    ProfileEntry::make<SSG748FMCProfile>("SSG 748"),
+    ProfileEntry::make<IXEG733FMCProfile>("IXEG 737"),
+};
+
 void ProductFMC::setProfileForCurrentAircraft() {
-    if (TolissFMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new TolissFMCProfile(this);
-        profileReady = true;
-    } else if (LaminarFMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new LaminarFMCProfile(this);
-        profileReady = true;
-    } else if (XCraftsFMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new XCraftsFMCProfile(this);
-        profileReady = true;
-    } else if (ZiboFMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new ZiboFMCProfile(this);
-        profileReady = true;
-    } else if (RotateMD11FMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new RotateMD11FMCProfile(this);
-        profileReady = true;
-    } else if (FlightFactor767FMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new FlightFactor767FMCProfile(this);
-        profileReady = true;
-    } else if (FlightFactor777FMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new FlightFactor777FMCProfile(this);
-        profileReady = true;
-    } else if (SSG748FMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new SSG748FMCProfile(this);
-        profileReady = true;
-    } else if (IXEG733FMCProfile::IsEligible()) {
-        clearDisplay();
-        profile = new IXEG733FMCProfile(this);
-        profileReady = true;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
     }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    clearDisplay();
+    profile = entry->create(this);
+    profileReady = true;
 }
 
 const char *ProductFMC::classIdentifier() {
@@ -179,7 +180,11 @@ void ProductFMC::blackout() {
 }
 
 void ProductFMC::unloadProfile() {
+    RenderWorker::getInstance()->waitForJobs(this);
+    renderCache.erase({profileEntry, deviceVariant});
     profileReady = false;
+    profileEntry = nullptr;
+    drawnGeneration = 0;
 
     if (!profile) {
         return;
@@ -187,22 +192,25 @@ void ProductFMC::unloadProfile() {
 
     delete profile;
     profile = nullptr;
+
+    setAllLedsEnabled(false);
+    clearDisplay();
+    showBackground(FMCBackgroundVariant::WINCTRL_LOGO);
 }
 
-void ProductFMC::update() {
+void ProductFMC::render() {
     if (!connected) {
         return;
     }
 
     if (!profile) {
-        setProfileForCurrentAircraft();
         return;
     }
 
-    USBDevice::update();
+    // Frames submitted on earlier updates are picked up as soon as the render worker has encoded them
+    drawRenderedFrame();
 
-    if (++displayUpdateFrameCounter >= std::max(getDisplayUpdateFrameInterval(), 4)) {
-        displayUpdateFrameCounter = 0;
+    if (AppState::getInstance()->shouldRefresh(this, getDisplayRefreshBackoff())) {
         updatePage();
     }
 }
@@ -285,92 +293,110 @@ void ProductFMC::didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, ui
 }
 
 void ProductFMC::updatePage(bool forceUpdate) {
+    std::shared_ptr<FMCRenderedFrame> &frame = renderCache[{profileEntry, deviceVariant}];
     auto datarefManager = Dataref::getInstance();
-    bool shouldUpdate = forceUpdate;
+    bool shouldRender = forceUpdate || !frame;
 
     for (const std::string &dataref : profile->displayDatarefs()) {
-        if (!lastUpdateCycle || datarefManager->getCachedLastUpdate(dataref.c_str()) > lastUpdateCycle) {
-            shouldUpdate = true;
+        if (shouldRender) {
             break;
         }
+
+        if (datarefManager->getCachedLastUpdate(dataref.c_str()) > frame->renderedCycle) {
+            shouldRender = true;
+        }
     }
 
-    if (shouldUpdate) {
-        profile->updatePage(page);
-        lastUpdateCycle = XPLMGetCycleNumber();
-        draw();
+    if (!shouldRender) {
+        return;
     }
-}
 
-void ProductFMC::draw(const std::vector<std::vector<char>> *pagePtr) {
-    const auto &p = pagePtr ? *pagePtr : page;
-    std::vector<uint8_t> buf;
+    // The page is the snapshot of the dataref reads, encoding happens on the render worker
+    auto next = std::make_shared<FMCRenderedFrame>();
+    profile->updatePage(next->page);
+    next->renderedCycle = XPLMGetCycleNumber();
+    next->generation = ++renderGeneration;
+    forceNextDraw = forceNextDraw || forceUpdate;
 
-    for (int i = 0; i < ProductFMC::PageLines; ++i) {
-        for (int j = 0; j < ProductFMC::PageCharsPerLine; ++j) {
-            char color = p[i][j * ProductFMC::PageBytesPerChar];
-            bool fontSmall = p[i][j * ProductFMC::PageBytesPerChar + 1];
-            auto [dataLow, dataHigh] = dataFromColFont(color, fontSmall);
-            buf.push_back(dataLow);
-            buf.push_back(dataHigh);
-
-            char val = p[i][j * ProductFMC::PageBytesPerChar + ProductFMC::PageBytesPerChar - 1];
-            profile->mapCharacter(&buf, val, fontSmall);
-        }
-    }
+    const FMCEncodingTable *encoding = &profile->encodingTable();
+    RenderWorker::getInstance()->submit(this, [next, encoding]() {
+        encode(*next, *encoding);
+        next->encoded = true;
+    });
+    frame = next;
+}
 
-    while (!buf.empty()) {
-        size_t maxLength = std::min<size_t>(63, buf.size());
-        std::vector<uint8_t> usbBuf(buf.begin(), buf.begin() + maxLength);
-        usbBuf.insert(usbBuf.begin(), 0xf2);
-        if (maxLength < 63) {
-            usbBuf.insert(usbBuf.end(), 63 - maxLength, 0);
-        }
-        writeData(usbBuf);
-        buf.erase(buf.begin(), buf.begin() + maxLength);
+void ProductFMC::drawRenderedFrame() {
+    auto it = renderCache.find({profileEntry, deviceVariant});
+    if (it == renderCache.end() || !it->second) {
+        return;
     }
-}
 
-std::pair<uint8_t, uint8_t> ProductFMC::dataFromColFont(char color, bool fontSmall) {
-    if (!profile) {
-        return {0x42, 0x00}; // Default white
+    const FMCRenderedFrame &frame = *it->second;
+    if (frame.generation == drawnGeneration || !frame.encoded) {
+        return;
     }
 
-    const std::map<char, FMCTextColor> &col_map = profile->colorMap();
+    drawnGeneration = frame.generation;
+    latency.markRender();
 
-    auto it = col_map.find(color);
-    int value = it != col_map.end() ? it->second : FMCTextColor::COLOR_WHITE;
-    if (fontSmall) {
-        value += 0x016b;
+    // Many display datarefs change without changing what is shown, identical frames are not sent again.
+    // The 0xf2 stream has no start row, so any dirty row still means a full frame.
+    if (lastDrawnPageValid && !forceNextDraw && frame.page.dirtyRows(lastDrawnPage).none()) {
+        skippedPacketCount += frame.reportCount;
+        return;
     }
 
-    return {static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>((value >> 8) & 0xFF)};
+    forceNextDraw = false;
+    draw(frame);
+    lastDrawnPage = frame.page;
+    lastDrawnPageValid = true;
 }
 
-void ProductFMC::writeLineToPage(std::vector<std::vector<char>> &page, int line, int pos, const std::string &text, char color, bool fontSmall) {
-    if (line < 0 || line >= ProductFMC::PageLines) {
-        debug("Not writing line %i: Line number is out of range!\n", line);
-        return;
-    }
-    if (pos < 0 || pos + text.length() > ProductFMC::PageCharsPerLine) {
-        debug("Not writing line %i: Position number (%i) is out of range!\n", line, pos);
-        return;
+void ProductFMC::encode(FMCRenderedFrame &frame, const FMCEncodingTable &encoding) {
+    constexpr unsigned int payloadLength = FMCRenderedFrame::ReportPayloadLength;
+
+    // Cells are encoded straight into the 0xf2 report slots, each carrying ReportPayloadLength bytes of the frame
+    size_t length = 0;
+    auto append = [&](uint8_t byte) {
+        if (length < FMCRenderedFrame::MaxReports * payloadLength) {
+            frame.reports[length / payloadLength][1 + length % payloadLength] = byte;
+            length++;
+        }
+    };
+
+    for (int i = 0; i < ProductFMC::PageLines; ++i) {
+        for (int j = 0; j < ProductFMC::PageCharsPerLine; ++j) {
+            const FMCCell &cell = frame.page.at(i, j);
+            const auto &color = encoding.colors[cell.fontSmall][static_cast<uint8_t>(cell.color)];
+            append(color[0]);
+            append(color[1]);
+
+            const FMCGlyphEncoding &glyph = encoding.glyphs[cell.fontSmall][static_cast<uint8_t>(cell.glyph)];
+            for (uint8_t k = 0; k < glyph.length; ++k) {
+                append(glyph.bytes[k]);
+            }
+        }
     }
-    if (text.length() > ProductFMC::PageCharsPerLine) {
-        debug("Not writing line %i: Text is too long (%lu) for line.\n", line, text.length());
-        return;
+
+    frame.reportCount = (length + payloadLength - 1) / payloadLength;
+    for (size_t r = 0; r < frame.reportCount; ++r) {
+        auto &report = frame.reports[r];
+        report[0] = 0xf2;
+
+        size_t used = std::min<size_t>(payloadLength, length - r * payloadLength);
+        std::fill(report.begin() + 1 + used, report.end(), 0);
     }
+}
 
-    pos = pos * ProductFMC::PageBytesPerChar;
-    for (size_t c = 0; c < text.length(); ++c) {
-        page[line][pos + c * ProductFMC::PageBytesPerChar] = color;
-        page[line][pos + c * ProductFMC::PageBytesPerChar + 1] = fontSmall;
-        page[line][pos + c * ProductFMC::PageBytesPerChar + ProductFMC::PageBytesPerChar - 1] = text[c];
+void ProductFMC::draw(const FMCRenderedFrame &frame) {
+    for (size_t r = 0; r < frame.reportCount; ++r) {
+        writeData(frame.reports[r].data(), frame.reports[r].size());
     }
 }
 
 void ProductFMC::clearDisplay() {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageBytesPerLine, ' '));
+    lastDrawnPageValid = false;
 
     std::vector<uint8_t> blankLine = {};
     blankLine.push_back(0xf2);
@@ -400,28 +426,36 @@ void ProductFMC::setFont(FontVariant preferredVariant) {
         shouldLoadDefaultFont = true;
     }
 
-    std::vector<std::vector<unsigned char>> font = {};
+    std::shared_ptr<const FontData> font = nullptr;
     if (shouldLoadDefaultFont) {
         font = Font::GlyphData(preferredVariant, identifierByte, hardwareType);
     } else {
         font = Font::GlyphData(fontPreference, identifierByte, hardwareType);
     }
 
-    if (font.empty()) {
+    if (!font || font->packets.empty()) {
         debug_force("Failed to load font data for font '%s'\n", fontPreference.c_str());
         AppState::getInstance()->writePreference("FMCFont", "default");
         return;
     }
 
-    for (auto &fontBytes : font) {
-        writeData(fontBytes);
+    // The device keeps its glyphs while connected, only glyphs that differ from the loaded font are sent
+    auto packets = Font::Delta(uploadedFont.get(), *font);
+    if (!packets.empty()) {
+        debug("%s: uploading %zu of %zu font packets\n", classIdentifier(), packets.size(), font->packets.size());
+    }
+
+    for (auto *fontBytes : packets) {
+        writeData(*fontBytes);
     }
+    uploadedFont = font;
 
     showBackground(FMCBackgroundVariant::BLACK);
 }
 
 void ProductFMC::showBackground(FMCBackgroundVariant variant) {
     std::vector<uint8_t> data;
+    lastDrawnPageValid = false;
 
     switch (variant) {
         case FMCBackgroundVariant::GRAY:
@@ -1,54 +1,75 @@
 #ifndef PRODUCT_FMC_H
 #define PRODUCT_FMC_H
 
+#include "aircraft-detector.h"
 #include "fmc-aircraft-profile.h"
 #include "font.h"
 #include "usbdevice.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <set>
 
+// Worst case frame: every cell is a color pair plus a three byte glyph
+struct FMCRenderedFrame {
+        static constexpr unsigned int ReportLength = 64;
+        static constexpr unsigned int ReportPayloadLength = ReportLength - 1;
+        static constexpr unsigned int MaxReports = (FMCPage::Lines * FMCPage::CharsPerLine * 5 + ReportPayloadLength - 1) / ReportPayloadLength;
+
+        FMCPage page;
+        int renderedCycle = 0;
+        uint64_t generation = 0;
+        std::atomic<bool> encoded = false;
+        size_t reportCount = 0;
+        std::array<std::array<uint8_t, ReportLength>, MaxReports> reports = {};
+};
+
 class ProductFMC : public USBDevice {
     private:
-        FMCAircraftProfile *profile;
-        std::vector<std::vector<char>> page;
-        int lastUpdateCycle;
-        int displayUpdateFrameCounter = 0;
+        FMCAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductFMC, FMCAircraftProfile> *profileEntry = nullptr;
+        FMCPage lastDrawnPage;
+        bool lastDrawnPageValid = false;
+        uint64_t drawnGeneration = 0;
+        bool forceNextDraw = false;
         std::set<int> pressedButtonIndices;
         uint64_t lastButtonStateLo;
         uint32_t lastButtonStateHi;
         int menuItemId;
         int fontsMenuItemId;
         FontVariant preferredFontVariant = FontVariant::Default;
+        std::shared_ptr<const FontData> uploadedFont = nullptr;
 
-        void draw(const std::vector<std::vector<char>> *pagePtr = nullptr);
-        std::pair<uint8_t, uint8_t> dataFromColFont(char color, bool fontSmall = false);
+        // Devices showing the same CDU side through the same profile share one rendered and encoded frame
+        static std::map<std::pair<const AircraftProfileEntry<ProductFMC, FMCAircraftProfile> *, FMCDeviceVariant>, std::shared_ptr<FMCRenderedFrame>> renderCache;
+        static uint64_t renderGeneration;
 
-        void setProfileForCurrentAircraft();
+        static void encode(FMCRenderedFrame &frame, const FMCEncodingTable &encoding);
+        void draw(const FMCRenderedFrame &frame);
+        void drawRenderedFrame();
 
     public:
         ProductFMC(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName, FMCHardwareType hardwareType, FMCDeviceVariant variant, unsigned char identifierByte);
         ~ProductFMC();
 
-        static constexpr unsigned int PageLines = 14; // Header + 6 * label + 6 * cont + textbox
-        static constexpr unsigned int PageCharsPerLine = 24;
-        static constexpr unsigned int PageBytesPerChar = 3;
-        static constexpr unsigned int PageBytesPerLine = PageCharsPerLine * PageBytesPerChar;
+        static constexpr unsigned int PageLines = FMCPage::Lines;
+        static constexpr unsigned int PageCharsPerLine = FMCPage::CharsPerLine;
         FMCHardwareType hardwareType;
         const unsigned char identifierByte;
         const FMCDeviceVariant deviceVariant;
 
         const char *classIdentifier() override;
         bool connect() override;
-        void unloadProfile();
-        void update() override;
+        void unloadProfile() override;
+        void render() override;
+        void setProfileForCurrentAircraft() override;
         void blackout() override;
         void updatePage(bool forceUpdate = false);
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
 
-        void writeLineToPage(std::vector<std::vector<char>> &page, int line, int pos, const std::string &text, char color, bool fontSmall = false);
         void setFont(FontVariant preferredVariant);
 
         void setAllLedsEnabled(bool enable);
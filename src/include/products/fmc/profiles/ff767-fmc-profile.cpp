@@ -1,5 +1,6 @@
 #include "ff767-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -34,8 +35,8 @@ FlightFactor767FMCProfile::~FlightFactor767FMCProfile() {
 }
 
 bool FlightFactor767FMCProfile::IsEligible() {
-    static const std::string author = Dataref::getInstance()->get<std::string>("sim/aircraft/view/acf_author");
-    static const std::string icao = Dataref::getInstance()->get<std::string>("sim/aircraft/view/acf_ICAO");
+    const std::string &author = AircraftDetector::getInstance()->signature().author;
+    const std::string &icao = AircraftDetector::getInstance()->signature().icao;
 
     if (!author.starts_with("FlightFactor")) {
         return false;
@@ -193,15 +194,15 @@ void FlightFactor767FMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8
     }
 }
 
-void FlightFactor767FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void FlightFactor767FMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
-    const std::string cdu = product->deviceVariant == FMCDeviceVariant::VARIANT_CAPTAIN ? "cduL" : "cduR";
-    std::vector<unsigned char> symbols = datarefManager->getCached<std::vector<unsigned char>>(("1-sim/" + cdu + "/display/symbols").c_str());
-    std::vector<int> colors = datarefManager->getCached<std::vector<int>>(("1-sim/" + cdu + "/display/symbolsColor").c_str());
-    std::vector<int> sizes = datarefManager->getCached<std::vector<int>>(("1-sim/" + cdu + "/display/symbolsSize").c_str());
-    std::vector<int> effects = datarefManager->getCached<std::vector<int>>(("1-sim/" + cdu + "/display/symbolsEffects").c_str());
+    const auto &refs = displayDatarefs();
+    std::vector<unsigned char> symbols = datarefManager->getCached<std::vector<unsigned char>>(refs[0].c_str());
+    std::vector<int> colors = datarefManager->getCached<std::vector<int>>(refs[1].c_str());
+    std::vector<int> effects = datarefManager->getCached<std::vector<int>>(refs[2].c_str());
+    std::vector<int> sizes = datarefManager->getCached<std::vector<int>>(refs[3].c_str());
 
     if (symbols.size() < FlightFactor767FMCProfile::DataLength || colors.size() < FlightFactor767FMCProfile::DataLength || sizes.size() < FlightFactor767FMCProfile::DataLength || effects.size() < FlightFactor767FMCProfile::DataLength) {
         return;
@@ -230,7 +231,7 @@ void FlightFactor767FMCProfile::updatePage(std::vector<std::vector<char>> &page)
                 color = 6;
             }
 
-            product->writeLineToPage(page, line, pos, std::string(1, symbol), color, fontSmall);
+            page.writeCell(line, pos, symbol, color, fontSmall);
         }
     }
 }
@@ -1,5 +1,6 @@
 #include "ff777-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -53,7 +54,7 @@ FlightFactor777FMCProfile::~FlightFactor777FMCProfile() {
 }
 
 bool FlightFactor777FMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("1-sim/cduL/display/symbols");
+    return AircraftDetector::getInstance()->hasDataref("1-sim/cduL/display/symbols");
 }
 
 const std::vector<std::string> &FlightFactor777FMCProfile::displayDatarefs() const {
@@ -205,8 +206,8 @@ void FlightFactor777FMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8
     }
 }
 
-void FlightFactor777FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void FlightFactor777FMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
     const std::string cdu = product->deviceVariant == FMCDeviceVariant::VARIANT_CAPTAIN ? "cduL" : (product->deviceVariant == FMCDeviceVariant::VARIANT_FIRSTOFFICER ? "cduR" : "cduC");
@@ -242,7 +243,7 @@ void FlightFactor777FMCProfile::updatePage(std::vector<std::vector<char>> &page)
                 color = 6;
             }
 
-            product->writeLineToPage(page, line, pos, std::string(1, symbol), color, fontSmall);
+            page.writeCell(line, pos, symbol, color, fontSmall);
         }
     }
 }
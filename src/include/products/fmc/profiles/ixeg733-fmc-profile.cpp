@@ -1,5 +1,6 @@
 #include "ixeg733-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -33,7 +34,7 @@ IXEG733FMCProfile::~IXEG733FMCProfile() {
 }
 
 bool IXEG733FMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("ixeg/733/FMC/cdu1_menu");
+    return AircraftDetector::getInstance()->hasDataref("ixeg/733/FMC/cdu1_menu");
 }
 
 const std::vector<std::string> &IXEG733FMCProfile::displayDatarefs() const {
@@ -253,8 +254,8 @@ std::pair<std::string, std::vector<char>> IXEG733FMCProfile::processIxegText(con
     return std::make_pair(text, colors);
 }
 
-void IXEG733FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void IXEG733FMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
     for (const auto &ref : displayDatarefs()) {
@@ -268,7 +269,7 @@ void IXEG733FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             for (int i = 0; i < text.size() && i < ProductFMC::PageCharsPerLine; ++i) {
                 char c = text[i];
                 char color = i < colors.size() ? colors[i] : 'G';
-                product->writeLineToPage(page, 0, i, std::string(1, c), color, color == 'S');
+                page.writeCell(0, i, c, color, color == 'S');
             }
             continue;
         }
@@ -279,7 +280,7 @@ void IXEG733FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
                 for (int i = 0; i < text.size() && (startPos + i) < ProductFMC::PageCharsPerLine; ++i) {
                     char c = text[i];
                     char color = i < colors.size() ? colors[i] : 'G';
-                    product->writeLineToPage(page, 0, startPos + i, std::string(1, c), color, color == 'S');
+                    page.writeCell(0, startPos + i, c, color, color == 'S');
                 }
             }
             continue;
@@ -289,7 +290,7 @@ void IXEG733FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             for (int i = 0; i < text.size() && i < ProductFMC::PageCharsPerLine; ++i) {
                 char c = text[i];
                 char color = i < colors.size() ? colors[i] : 'G';
-                product->writeLineToPage(page, 13, i, std::string(1, c), color, color == 'S');
+                page.writeCell(13, i, c, color, color == 'S');
             }
             continue;
         }
@@ -321,7 +322,7 @@ void IXEG733FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
                     for (int i = 0; i < text.size() && (startPos + i) < ProductFMC::PageCharsPerLine; ++i) {
                         char c = text[i];
                         char color = i < colors.size() ? colors[i] : 'G';
-                        product->writeLineToPage(page, displayLine, startPos + i, std::string(1, c), color, isTitle || color == 'S');
+                        page.writeCell(displayLine, startPos + i, c, color, isTitle || color == 'S');
                     }
                 }
             }
@@ -1,5 +1,6 @@
 #include "laminar-airbus-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "dataref.h"
 #include "product-fmc.h"
 
@@ -34,7 +35,7 @@ LaminarFMCProfile::~LaminarFMCProfile() {
 }
 
 bool LaminarFMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("laminar/A333/ckpt_temp");
+    return AircraftDetector::getInstance()->hasDataref("laminar/A333/ckpt_temp");
 }
 
 const std::vector<std::string> &LaminarFMCProfile::displayDatarefs() const {
@@ -226,8 +227,8 @@ void LaminarFMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t chara
     }
 }
 
-void LaminarFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void LaminarFMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
     for (int lineNum = 0; lineNum < std::min(ProductFMC::PageLines, (unsigned int) 16); ++lineNum) {
@@ -279,7 +280,7 @@ void LaminarFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
                 break;
             }
 
-            product->writeLineToPage(page, displayLine, i, std::string(1, c), styleByte & 0x0F, fontSmall);
+            page.writeCell(displayLine, i, c, styleByte & 0x0F, fontSmall);
         }
     }
 }
@@ -1,5 +1,6 @@
 #include "rotatemd11-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "config.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -59,7 +60,7 @@ RotateMD11FMCProfile::~RotateMD11FMCProfile() {
 }
 
 bool RotateMD11FMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("Rotate/aircraft/controls/cdu_0/mcdu_line_0_content");
+    return AircraftDetector::getInstance()->hasDataref("Rotate/aircraft/controls/cdu_0/mcdu_line_0_content");
 }
 
 bool RotateMD11FMCProfile::shouldReadDatarefAsBytes(const std::string &dataref) const {
@@ -329,8 +330,8 @@ void RotateMD11FMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t ch
     }
 }
 
-void RotateMD11FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void RotateMD11FMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
     const std::string cdu = product->deviceVariant == FMCDeviceVariant::VARIANT_CAPTAIN ? "cdu_0" : "cdu_1";
@@ -362,7 +363,7 @@ void RotateMD11FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
 
             bool fontSmall = (styleCode == 4);
 
-            product->writeLineToPage(page, line, pos, std::string(1, c), 'g', fontSmall);
+            page.writeCell(line, pos, c, 'g', fontSmall);
         }
     }
 }
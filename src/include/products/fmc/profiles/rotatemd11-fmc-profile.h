@@ -18,7 +18,7 @@ class RotateMD11FMCProfile : public FMCAircraftProfile {
         const std::unordered_map<FMCKey, const FMCButtonDef *> &buttonKeyMap() const override;
         const std::map<char, FMCTextColor> &colorMap() const override;
         void mapCharacter(std::vector<uint8_t> *buffer, uint8_t character, bool isFontSmall) override;
-        void updatePage(std::vector<std::vector<char>> &page) override;
+        void updatePage(FMCPage &page) override;
         void buttonPressed(const FMCButtonDef *button, XPLMCommandPhase phase) override;
         bool shouldReadDatarefAsBytes(const std::string &dataref) const override;
 };
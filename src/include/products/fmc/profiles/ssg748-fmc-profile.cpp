@@ -1,5 +1,6 @@
 #include "ssg748-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -9,7 +10,20 @@
 #include <regex>
 
 SSG748FMCProfile::SSG748FMCProfile(ProductFMC *product) : FMCAircraftProfile(product) {
-    datarefRegex = std::regex("SSG/UFMC/LINE_([0-9]+)");
+    const std::regex datarefRegex("SSG/UFMC/LINE_([0-9]+)");
+    for (const auto &ref : displayDatarefs()) {
+        std::smatch match;
+        if (!std::regex_match(ref, match, datarefRegex)) {
+            continue;
+        }
+
+        int lineIndex = std::stoi(match[1]) - 1;
+        if (lineIndex < 0 || lineIndex >= ProductFMC::PageLines) {
+            continue;
+        }
+
+        layout.push_back({.dataref = ref.c_str(), .line = static_cast<unsigned char>(lineIndex), .color = 'W', .fontSmall = lineIndex % 2 == 1, .kind = FMCLayoutKind::Text});
+    }
 
     product->setAllLedsEnabled(false);
     product->setFont(FontVariant::FontVGA1);
@@ -35,7 +49,7 @@ SSG748FMCProfile::~SSG748FMCProfile() {
 }
 
 bool SSG748FMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("SSG/748/simtime");
+    return AircraftDetector::getInstance()->hasDataref("SSG/748/simtime");
 }
 
 const std::vector<std::string> &SSG748FMCProfile::displayDatarefs() const {
@@ -196,30 +210,20 @@ void SSG748FMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t charac
     }
 }
 
-void SSG748FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void SSG748FMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
-    for (const auto &ref : displayDatarefs()) {
-        std::smatch match;
-        if (!std::regex_match(ref, match, datarefRegex)) {
-            continue;
-        }
-
-        int lineNum = std::stoi(match[1]);
-        int lineIndex = lineNum - 1;
-
-        if (lineIndex < 0 || lineIndex >= ProductFMC::PageLines) {
-            continue;
-        }
-
-        std::string text = datarefManager->getCached<std::string>(ref.c_str());
+    for (const auto &entry : layout) {
+        std::string text = datarefManager->getCached<std::string>(entry.dataref);
         if (text.empty()) {
             continue;
         }
 
-        char currentColor = 'W';
-        bool fontSmall = lineIndex % 2 == 1;
+        // Lines carry inline ";x" color codes, the entry color applies until the first one
+        char currentColor = entry.color;
+        int lineIndex = entry.line;
+        bool fontSmall = entry.fontSmall;
         int displayPos = 0;
 
         for (int i = 0; i < text.size() && displayPos < ProductFMC::PageCharsPerLine; ++i) {
@@ -236,14 +240,14 @@ void SSG748FMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             }
 
             if (c == '[' && i + 1 < text.size() && text[i + 1] == ']') {
-                product->writeLineToPage(page, lineIndex, displayPos, "#", currentColor, fontSmall);
+                page.writeCell(lineIndex, displayPos, '#', currentColor, fontSmall);
                 i++; // Skip the closing bracket
                 displayPos++;
                 continue;
             }
 
             if (c != 0x20) {
-                product->writeLineToPage(page, lineIndex, displayPos, std::string(1, toupper(c)), currentColor, fontSmall);
+                page.writeCell(lineIndex, displayPos, toupper(c), currentColor, fontSmall);
             }
             displayPos++;
         }
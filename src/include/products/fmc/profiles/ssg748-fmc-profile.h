@@ -3,11 +3,9 @@
 
 #include "fmc-aircraft-profile.h"
 
-#include <regex>
-
 class SSG748FMCProfile : public FMCAircraftProfile {
     private:
-        std::regex datarefRegex;
+        std::vector<FMCLayoutEntry> layout;
 
     public:
         SSG748FMCProfile(ProductFMC *product);
@@ -20,7 +18,7 @@ class SSG748FMCProfile : public FMCAircraftProfile {
         const std::unordered_map<FMCKey, const FMCButtonDef *> &buttonKeyMap() const override;
         const std::map<char, FMCTextColor> &colorMap() const override;
         void mapCharacter(std::vector<uint8_t> *buffer, uint8_t character, bool isFontSmall) override;
-        void updatePage(std::vector<std::vector<char>> &page) override;
+        void updatePage(FMCPage &page) override;
         void buttonPressed(const FMCButtonDef *button, XPLMCommandPhase phase) override;
 };
 
@@ -1,15 +1,51 @@
 #include "toliss-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "config.h"
 #include "dataref.h"
 #include "product-fmc.h"
 
 #include <algorithm>
+#include <regex>
 
 TolissFMCProfile::TolissFMCProfile(ProductFMC *product) : FMCAircraftProfile(product) {
-    datarefRegex = std::regex("AirbusFBW/MCDU(1|2)([s]{0,1})([a-zA-Z]+)([0-6]{0,1})([L]{0,1})([a-z]{1})");
     isSelfTest = false;
 
+    const std::regex datarefRegex("AirbusFBW/MCDU(1|2)([s]{0,1})([a-zA-Z]+)([0-6]{0,1})([L]{0,1})([a-z]{1})");
+    for (const auto &ref : displayDatarefs()) {
+        if (ref.ends_with("spw") || ref.ends_with("spa")) {
+            layout.push_back({.dataref = ref.c_str(), .line = 13, .color = ref.ends_with("spa") ? 'a' : 'w', .fontSmall = false, .kind = FMCLayoutKind::Scratchpad});
+            continue;
+        }
+
+        std::smatch match;
+        if (!std::regex_match(ref, match, datarefRegex)) {
+            continue;
+        }
+
+        std::string type = match[3];
+        int number = match[4].str().empty() ? -1 : std::stoi(match[4]);
+        char color = match[6].str()[0];
+        bool fontSmall = match[2] == "s" || (type == "label" && match[5] != "L") || color == 's';
+
+        int line;
+        if (type.find("title") != std::string::npos) {
+            line = 0;
+        } else if (type.find("label") != std::string::npos) {
+            line = (number < 0 ? 1 : number) * 2 - 1;
+        } else if (type.find("cont") != std::string::npos) {
+            line = number < 0 ? 0 : number * 2;
+        } else {
+            continue;
+        }
+
+        if (line < 0 || line >= static_cast<int>(ProductFMC::PageLines)) {
+            continue;
+        }
+
+        layout.push_back({.dataref = ref.c_str(), .line = static_cast<unsigned char>(line), .color = color, .fontSmall = fontSmall, .kind = color == 's' ? FMCLayoutKind::Symbols : FMCLayoutKind::Text});
+    }
+
     product->setAllLedsEnabled(false);
     product->setFont(FontVariant::FontAirbus);
 
@@ -143,7 +179,7 @@ TolissFMCProfile::~TolissFMCProfile() {
 }
 
 bool TolissFMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("AirbusFBW/DUBrightness");
+    return AircraftDetector::getInstance()->hasDataref("AirbusFBW/DUBrightness");
 }
 
 const std::vector<std::string> &TolissFMCProfile::displayDatarefs() const {
@@ -460,8 +496,9 @@ void TolissFMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t charac
     }
 }
 
-void TolissFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
+void TolissFMCProfile::updatePage(FMCPage &page) {
     if (isSelfTest) {
+        page.clear();
         product->clearDisplay();
         return;
     }
@@ -469,31 +506,18 @@ void TolissFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
     std::string scratchpad = "";
     char scratchpadColor = 'w';
 
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
-    for (const auto &ref : displayDatarefs()) {
-        bool isScratchpad = (ref.size() >= 3 && (ref.substr(ref.size() - 3) == "spw" || ref.substr(ref.size() - 3) == "spa"));
-
-        std::smatch match;
-        if (!std::regex_match(ref, match, datarefRegex) && !isScratchpad) {
-            continue;
-        }
-
-        std::string type = match[3];
-        unsigned char line = match[4].str().empty() ? 0 : std::stoi(match[4]) * 2;
-        char color = match[6].str()[0];
-        bool fontSmall = match[2] == "s" || (type == "label" && match[5] != "L") || color == 's';
-
-        std::string text = datarefManager->getCached<std::string>(ref.c_str());
-
+    for (const auto &entry : layout) {
+        std::string text = datarefManager->getCached<std::string>(entry.dataref);
         if (text.empty()) {
             continue;
         }
 
-        if (isScratchpad) {
+        if (entry.kind == FMCLayoutKind::Scratchpad) {
             scratchpad = text;
-            scratchpadColor = ref.size() >= 3 && ref.substr(ref.size() - 3) == "spa" ? 'a' : 'w';
+            scratchpadColor = entry.color;
             continue;
         }
 
@@ -504,8 +528,8 @@ void TolissFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
                 continue;
             }
 
-            unsigned char targetColor = color;
-            if (color == 's') {
+            char targetColor = entry.color;
+            if (entry.kind == FMCLayoutKind::Symbols) {
                 switch (c) {
                     case 'A':
                         c = 91;
@@ -546,14 +570,7 @@ void TolissFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
                 }
             }
 
-            if (type.find("title") != std::string::npos || type.find("stitle") != std::string::npos) {
-                product->writeLineToPage(page, 0, i, std::string(1, c), targetColor, fontSmall);
-            } else if (type.find("label") != std::string::npos) {
-                unsigned char lbl_line = (match[4].str().empty() ? 1 : std::stoi(match[4])) * 2 - 1;
-                product->writeLineToPage(page, lbl_line, i, std::string(1, c), targetColor, fontSmall);
-            } else if (type.find("cont") != std::string::npos || type.find("scont") != std::string::npos) {
-                product->writeLineToPage(page, line, i, std::string(1, c), targetColor, fontSmall);
-            }
+            page.writeCell(entry.line, i, c, targetColor, entry.fontSmall);
         }
     }
 
@@ -568,14 +585,14 @@ void TolissFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             }
         }
 
-        product->writeLineToPage(page, 13, 0, scratchpad, scratchpadColor, false);
+        page.writeSpan(13, 0, scratchpad, scratchpadColor, false);
 
         if (vertSlewType == 1 || vertSlewType == 2) {
-            product->writeLineToPage(page, 13, ProductFMC::PageCharsPerLine - 2, std::string(1, 30), 'w', true);
+            page.writeCell(13, ProductFMC::PageCharsPerLine - 2, 30, 'w', true);
         }
 
         if (vertSlewType == 1 || vertSlewType == 3) {
-            product->writeLineToPage(page, 13, ProductFMC::PageCharsPerLine - 1, std::string(1, 31), 'w', true);
+            page.writeCell(13, ProductFMC::PageCharsPerLine - 1, 31, 'w', true);
         }
     }
 }
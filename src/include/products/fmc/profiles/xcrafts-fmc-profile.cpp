@@ -1,5 +1,6 @@
 #include "xcrafts-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -13,8 +14,6 @@
 #include <XPLMUtilities.h>
 
 XCraftsFMCProfile::XCraftsFMCProfile(ProductFMC *product) : FMCAircraftProfile(product) {
-    datarefRegex = std::regex("XCrafts/FMS/CDU_[0-9]+_([0-9]{2}|ScratchPad)");
-
     product->setAllLedsEnabled(false);
     product->setFont(FontVariant::FontXCrafts);
 
@@ -38,7 +37,7 @@ XCraftsFMCProfile::~XCraftsFMCProfile() {
 }
 
 bool XCraftsFMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("XCrafts/FMS/CDU_1_01");
+    return AircraftDetector::getInstance()->hasDataref("XCrafts/FMS/CDU_1_01");
 }
 
 const std::vector<std::string> &XCraftsFMCProfile::displayDatarefs() const {
@@ -220,8 +219,8 @@ void XCraftsFMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t chara
     }
 }
 
-void XCraftsFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void XCraftsFMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
     const std::string cduNumber = product->deviceVariant == FMCDeviceVariant::VARIANT_CAPTAIN ? "1" : "2";
@@ -275,7 +274,7 @@ void XCraftsFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
 
                 int displayCol = colIndex + (j - textStartIndex);
                 bool isSmallFont = fontStyle == XCraftsFMCFontStyle::Small || fontStyle == XCraftsFMCFontStyle::SmallReversed || fontStyle == XCraftsFMCFontStyle::SmallReversedBox;
-                product->writeLineToPage(page, lineIndex, displayCol, std::string(1, (char) c), colorCode, isSmallFont);
+                page.writeCell(lineIndex, displayCol, (char) c, colorCode, isSmallFont);
             }
         }
     }
@@ -287,7 +286,7 @@ void XCraftsFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             if (c == 0x00 || c == '|') {
                 break;
             }
-            product->writeLineToPage(page, 13, i, std::string(1, (char) c), 0, false);
+            page.writeCell(13, i, (char) c, 0, false);
         }
     }
 }
@@ -3,8 +3,6 @@
 
 #include "fmc-aircraft-profile.h"
 
-#include <regex>
-
 enum class XCraftsFMCFontStyle : unsigned char {
     Large = 1,
     Small = 2,
@@ -15,9 +13,6 @@ enum class XCraftsFMCFontStyle : unsigned char {
 };
 
 class XCraftsFMCProfile : public FMCAircraftProfile {
-    private:
-        std::regex datarefRegex;
-
     public:
         XCraftsFMCProfile(ProductFMC *product);
         virtual ~XCraftsFMCProfile();
@@ -29,7 +24,7 @@ class XCraftsFMCProfile : public FMCAircraftProfile {
         const std::unordered_map<FMCKey, const FMCButtonDef *> &buttonKeyMap() const override;
         const std::map<char, FMCTextColor> &colorMap() const override;
         void mapCharacter(std::vector<uint8_t> *buffer, uint8_t character, bool isFontSmall) override;
-        void updatePage(std::vector<std::vector<char>> &page) override;
+        void updatePage(FMCPage &page) override;
         void buttonPressed(const FMCButtonDef *button, XPLMCommandPhase phase) override;
 };
 
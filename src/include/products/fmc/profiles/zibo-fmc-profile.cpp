@@ -1,5 +1,6 @@
 #include "zibo-fmc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-fmc.h"
@@ -8,9 +9,39 @@
 #include <cfloat>
 #include <cmath>
 #include <cstring>
+#include <regex>
 
 ZiboFMCProfile::ZiboFMCProfile(ProductFMC *product) : FMCAircraftProfile(product) {
-    datarefRegex = std::regex("laminar/B738/fmc[0-9]+/Line([0-9]{2})_([A-Z]+)");
+    const std::regex datarefRegex("laminar/B738/fmc[0-9]+/Line([0-9]{2})_([A-Z]+)");
+    for (const auto &ref : displayDatarefs()) {
+        // Scratchpad datarefs go to line 13
+        if (ref.ends_with("/Line_entry") || ref.ends_with("/Line_entry_I")) {
+            layout.push_back({.dataref = ref.c_str(), .line = 13, .color = ref.ends_with("_I") ? 'I' : 'W', .fontSmall = false, .kind = FMCLayoutKind::Scratchpad});
+            continue;
+        }
+
+        std::smatch match;
+        if (!std::regex_match(ref, match, datarefRegex)) {
+            continue;
+        }
+
+        int lineNum = std::stoi(match[1]);
+        std::string colorStr = match[2];
+
+        // For double-letter codes like "GX", "LX", use first letter for color
+        char color = colorStr[0];
+
+        int displayLine = lineNum * 2;
+        if (colorStr.back() == 'X') {
+            displayLine -= 1; // X datarefs go to odd lines (labels)
+        }
+
+        if (displayLine < 0 || displayLine >= ProductFMC::PageLines) {
+            continue;
+        }
+
+        layout.push_back({.dataref = ref.c_str(), .line = static_cast<unsigned char>(displayLine), .color = color, .fontSmall = color == 'X' || color == 'S', .kind = FMCLayoutKind::Text});
+    }
 
     product->setAllLedsEnabled(false);
     product->setFont(FontVariant::Font737);
@@ -58,7 +89,7 @@ ZiboFMCProfile::~ZiboFMCProfile() {
 }
 
 bool ZiboFMCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("laminar/B738/electric/instrument_brightness");
+    return AircraftDetector::getInstance()->hasDataref("laminar/B738/electric/instrument_brightness");
 }
 
 const std::vector<std::string> &ZiboFMCProfile::displayDatarefs() const {
@@ -270,50 +301,12 @@ void ZiboFMCProfile::mapCharacter(std::vector<uint8_t> *buffer, uint8_t characte
     }
 }
 
-void ZiboFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
-    page = std::vector<std::vector<char>>(ProductFMC::PageLines, std::vector<char>(ProductFMC::PageCharsPerLine * ProductFMC::PageBytesPerChar, ' '));
+void ZiboFMCProfile::updatePage(FMCPage &page) {
+    page.clear();
 
     auto datarefManager = Dataref::getInstance();
-    for (const auto &ref : displayDatarefs()) {
-        std::string text = datarefManager->getCached<std::string>(ref.c_str());
-
-        // Handle scratchpad datarefs specially
-        if (ref.ends_with("/Line_entry") || ref.ends_with("/Line_entry_I")) {
-            if (!text.empty()) {
-                const std::string fmc = product->deviceVariant == FMCDeviceVariant::VARIANT_CAPTAIN ? "fmc1" : "fmc2";
-                char color = (ref == "laminar/B738/" + fmc + "/Line_entry_I") ? 'I' : 'W';
-
-                // Store scratchpad text for later display on line 13
-                for (int i = 0; i < text.size() && i < ProductFMC::PageCharsPerLine; ++i) {
-                    char c = text[i];
-                    if (c == 0x00) {
-                        break; // End of string
-                    }
-                    if (c != 0x20) { // Skip spaces
-                        product->writeLineToPage(page, 13, i, std::string(1, c), color, false);
-                    }
-                }
-            }
-            continue;
-        }
-
-        std::smatch match;
-        if (!std::regex_match(ref, match, datarefRegex)) {
-            continue;
-        }
-
-        unsigned char lineNum = std::stoi(match[1]);
-        std::string colorStr = match[2];
-
-        // For double-letter codes like "GX", "LX", use first letter for color
-        char color = colorStr[0];
-
-        unsigned char displayLine = lineNum * 2;
-        bool fontSmall = color == 'X' || color == 'S';
-        if (colorStr.back() == 'X') {
-            displayLine -= 1; // X datarefs go to odd lines (labels)
-        }
-
+    for (const auto &entry : layout) {
+        std::string text = datarefManager->getCached<std::string>(entry.dataref);
         if (text.empty()) {
             continue;
         }
@@ -325,7 +318,7 @@ void ZiboFMCProfile::updatePage(std::vector<std::vector<char>> &page) {
             }
 
             if (c != 0x20) {
-                product->writeLineToPage(page, displayLine, i, std::string(1, c), color, fontSmall);
+                page.writeCell(entry.line, i, c, entry.color, entry.fontSmall);
             }
         }
     }
@@ -3,14 +3,17 @@
 #include "appstate.h"
 #include "config.h"
 #include "dataref.h"
+#include "display-model.h"
 #include "pap3-mcp-lcd-segments.h"
 #include "plugins-menu.h"
 #include "profiles/ff777-pap3-mcp-profile.h"
 #include "profiles/laminar-pap3-mcp-profile.h"
 #include "profiles/rotatemd11-pap3-mcp-profile.h"
 #include "profiles/zibo-pap3-mcp-profile.h"
+#include "render-worker.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 #include <iomanip>
@@ -22,17 +25,46 @@
 
 using namespace pap3mcp::lcd;
 
+template<auto Member>
+static constexpr DisplayField<PAP3MCPDisplayData> field(uint32_t regions) {
+    return displayField<PAP3MCPDisplayData, Member>(regions);
+}
+
+// The LED flags are not part of the model, they are driven by the profiles directly
+static constexpr auto displayFields = std::to_array<DisplayField<PAP3MCPDisplayData>>({
+    field<&PAP3MCPDisplayData::speed>(PAP3_DISPLAY_G0),
+    field<&PAP3MCPDisplayData::speedVisible>(PAP3_DISPLAY_G0),
+    field<&PAP3MCPDisplayData::digitA>(PAP3_DISPLAY_G0),
+    field<&PAP3MCPDisplayData::digitB>(PAP3_DISPLAY_G0),
+    field<&PAP3MCPDisplayData::crsCapt>(PAP3_DISPLAY_G0),
+    field<&PAP3MCPDisplayData::heading>(PAP3_DISPLAY_G1),
+    field<&PAP3MCPDisplayData::headingVisible>(PAP3_DISPLAY_G1),
+    field<&PAP3MCPDisplayData::altitude>(PAP3_DISPLAY_G1 | PAP3_DISPLAY_G2),
+    field<&PAP3MCPDisplayData::verticalSpeed>(PAP3_DISPLAY_G2),
+    field<&PAP3MCPDisplayData::verticalSpeedVisible>(PAP3_DISPLAY_G2),
+    field<&PAP3MCPDisplayData::crsFo>(PAP3_DISPLAY_G3),
+    field<&PAP3MCPDisplayData::showCourse>(PAP3_DISPLAY_G0 | PAP3_DISPLAY_G3),
+    field<&PAP3MCPDisplayData::showLabels>(PAP3_DISPLAY_ALL),
+    field<&PAP3MCPDisplayData::showDashesWhenInactive>(PAP3_DISPLAY_ALL),
+    field<&PAP3MCPDisplayData::showLabelsWhenInactive>(PAP3_DISPLAY_ALL),
+    field<&PAP3MCPDisplayData::displayEnabled>(PAP3_DISPLAY_ALL),
+    field<&PAP3MCPDisplayData::displayTest>(PAP3_DISPLAY_ALL),
+});
+static_assert(displayFields.size() == ProductPAP3MCP::DisplayFieldCount);
+
 ProductPAP3MCP::ProductPAP3MCP(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName) :
-    USBDevice(hidDevice, vendorId, productId, vendorName, productName) {
+    USBDevice(hidDevice, vendorId, productId, vendorName, productName), displayModel(displayFields) {
     profile = nullptr;
-    displayData = {};
     lastUpdateCycle = 0;
     pressedButtonIndices = {};
+    AppState::getInstance()->registerRefresh(this, 30.0f, 20);
 
     connect();
 }
 
 ProductPAP3MCP::~ProductPAP3MCP() {
+    AppState::getInstance()->unregisterRefresh(this);
+    RenderWorker::getInstance()->waitForJobs(this);
     blackout();
 
     PluginsMenu::getInstance()->removeItem(menuItemId);
@@ -43,20 +75,45 @@ ProductPAP3MCP::~ProductPAP3MCP() {
     }
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductPAP3MCP, PAP3MCPAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<ZiboPAP3MCPProfile>("Zibo 737"),
+    ProfileEntry::make<FF777PAP3MCPProfile>("FlightFactor 777"),
+    ProfileEntry::make<RotateMD11PAP3MCPProfile>("Rotate MD-11"),
+    ProfileEntry::make<LaminarPAP3MCPProfile>("Laminar"),
+};
+
 void ProductPAP3MCP::setProfileForCurrentAircraft() {
-    if (ZiboPAP3MCPProfile::IsEligible()) {
-        profile = new ZiboPAP3MCPProfile(this);
-        profileReady = true;
-    } else if (FF777PAP3MCPProfile::IsEligible()) {
-        profile = new FF777PAP3MCPProfile(this);
-        profileReady = true;
-    } else if (RotateMD11PAP3MCPProfile::IsEligible()) {
-        profile = new RotateMD11PAP3MCPProfile(this);
-        profileReady = true;
-    } else if (LaminarPAP3MCPProfile::IsEligible()) {
-        profile = new LaminarPAP3MCPProfile(this);
-        profileReady = true;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
+    }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+}
+
+void ProductPAP3MCP::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
     }
+
+    delete profile;
+    profile = nullptr;
+
+    setAllLedsEnabled(false);
+    clearDisplays();
 }
 
 const char *ProductPAP3MCP::classIdentifier() {
@@ -109,20 +166,16 @@ void ProductPAP3MCP::blackout() {
     clearDisplays();
 }
 
-void ProductPAP3MCP::update() {
+void ProductPAP3MCP::render() {
     if (!connected) {
         return;
     }
 
     if (!profile) {
-        setProfileForCurrentAircraft();
         return;
     }
 
-    USBDevice::update();
-
-    if (++displayUpdateFrameCounter >= getDisplayUpdateFrameInterval()) {
-        displayUpdateFrameCounter = 0;
+    if (AppState::getInstance()->shouldRefresh(this, getDisplayRefreshBackoff())) {
         updateDisplays(false);
     }
 }
@@ -141,31 +194,18 @@ void ProductPAP3MCP::updateDisplays(bool force) {
         return;
     }
 
-    // Save old display data for comparison
-    PAP3MCPDisplayData oldDisplayData = displayData;
-    profile->updateDisplayData(displayData);
-
-    // Update LCD if data changed
-    if (displayData.speed != oldDisplayData.speed ||
-        displayData.heading != oldDisplayData.heading ||
-        displayData.altitude != oldDisplayData.altitude ||
-        displayData.verticalSpeed != oldDisplayData.verticalSpeed ||
-        displayData.verticalSpeedVisible != oldDisplayData.verticalSpeedVisible ||
-        displayData.speedVisible != oldDisplayData.speedVisible ||
-        displayData.headingVisible != oldDisplayData.headingVisible ||
-        displayData.crsCapt != oldDisplayData.crsCapt ||
-        displayData.crsFo != oldDisplayData.crsFo ||
-        displayData.showCourse != oldDisplayData.showCourse ||
-        displayData.showLabels != oldDisplayData.showLabels ||
-        displayData.showDashesWhenInactive != oldDisplayData.showDashesWhenInactive ||
-        displayData.showLabelsWhenInactive != oldDisplayData.showLabelsWhenInactive ||
-        displayData.digitA != oldDisplayData.digitA ||
-        displayData.digitB != oldDisplayData.digitB ||
-        displayData.displayEnabled != oldDisplayData.displayEnabled ||
-        displayData.displayTest != oldDisplayData.displayTest) {
-        // Pass values directly - encoding happens in sendLCDDisplay
-        sendLCDDisplay("", displayData.heading, displayData.altitude, "", displayData.crsCapt, displayData.crsFo);
+    profile->updateDisplayData(displayModel.edit());
+    latency.markRender();
+
+    // All groups share one LCD payload, so any dirty group re-encodes the whole payload
+    if (displayModel.commit() & PAP3_DISPLAY_ALL) {
+        // The display data is the snapshot of the dataref reads, LCD encoding happens on the render worker.
+        // The latency origin is taken here, the tracker's output state belongs to the main thread.
+        RenderWorker::getInstance()->submit(this, [this, data = displayModel.value(), changedAt = latency.outputOrigin()]() {
+            sendLCDDisplay(data, changedAt);
+        });
     }
+    displayModel.clearDirty();
 
     if (shouldUpdate) {
         lastUpdateCycle = XPLMGetCycleNumber();
@@ -216,26 +256,28 @@ void ProductPAP3MCP::initializeDisplays() {
 }
 
 void ProductPAP3MCP::clearDisplays() {
-    displayData = {
+    RenderWorker::getInstance()->waitForJobs(this);
+
+    displayModel.reset({
         .displayEnabled = false,
-    };
+    });
 
-    sendLCDDisplay("", 0, 0, "", 0, 0);
+    sendLCDDisplay(displayModel.value());
 }
 
-void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int altitude, const std::string &vs, int crsCapt, int crsFo) {
+void ProductPAP3MCP::sendLCDDisplay(const PAP3MCPDisplayData &display, std::chrono::steady_clock::time_point changedAt) {
     Payload payload;
     std::fill(payload.begin(), payload.end(), 0x00);
 
-    if (!displayData.displayEnabled || displayData.displayTest) {
+    if (!display.displayEnabled || display.displayTest) {
         // Send empty payload
-        std::fill(payload.begin(), payload.end(), displayData.displayEnabled && displayData.displayTest ? 0xFF : 0x00);
+        std::fill(payload.begin(), payload.end(), display.displayEnabled && display.displayTest ? 0xFF : 0x00);
     } else {
         // SPD: IAS vs MACH rendering
-        const float spd = displayData.speed;
+        const float spd = display.speed;
         const bool isMach = (spd < 100.0f);
 
-        if (displayData.speedVisible && isMach) {
+        if (display.speedVisible && isMach) {
             // MACH mode
             float mach = (spd < 1.0f) ? std::clamp(spd, 0.0f, 0.9999f) : std::clamp(spd / 100.0f, 0.0f, 0.9999f);
             const int twoDigits = std::clamp(static_cast<int>(std::floor(mach * 1000.0f / 10.0f + 0.5f)), 0, 99);
@@ -245,14 +287,14 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
             drawDigit(G0, payload, SPD_TENS, tens);
             drawDigit(G0, payload, SPD_UNITS, units);
 
-            setFlag(payload, OFF_36, LBL_IAS, displayData.showLabels && false);
-            setFlag(payload, OFF_32, LBL_MACH_L, displayData.showLabels && true);
-            setFlag(payload, OFF_2E, LBL_MACH_R, displayData.showLabels && true);
+            setFlag(payload, OFF_36, LBL_IAS, display.showLabels && false);
+            setFlag(payload, OFF_32, LBL_MACH_L, display.showLabels && true);
+            setFlag(payload, OFF_2E, LBL_MACH_R, display.showLabels && true);
             setFlag(payload, OFF_19, DOT_SPD, true);
 
-            setFlag(payload, OFF_22, SPD_BAR_TOP, displayData.digitA);
-            setFlag(payload, OFF_1E, SPD_BAR_BOTTOM, displayData.digitA);
-        } else if (displayData.speedVisible) {
+            setFlag(payload, OFF_22, SPD_BAR_TOP, display.digitA);
+            setFlag(payload, OFF_1E, SPD_BAR_BOTTOM, display.digitA);
+        } else if (display.speedVisible) {
             // IAS mode
             const int ias = std::max(0, static_cast<int>(std::floor(spd + 0.5f)));
             int k, h, t, u;
@@ -270,29 +312,29 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
             drawDigit(G0, payload, SPD_TENS, t);
             drawDigit(G0, payload, SPD_UNITS, u);
 
-            setFlag(payload, OFF_36, LBL_IAS, displayData.showLabels && true);
-            setFlag(payload, OFF_32, LBL_MACH_L, displayData.showLabels && false);
-            setFlag(payload, OFF_2E, LBL_MACH_R, displayData.showLabels && false);
+            setFlag(payload, OFF_36, LBL_IAS, display.showLabels && true);
+            setFlag(payload, OFF_32, LBL_MACH_L, display.showLabels && false);
+            setFlag(payload, OFF_2E, LBL_MACH_R, display.showLabels && false);
             setFlag(payload, OFF_19, DOT_SPD, false);
 
-            setFlag(payload, OFF_22, SPD_BAR_TOP, displayData.digitA);
-            setFlag(payload, OFF_1E, SPD_BAR_BOTTOM, displayData.digitA);
+            setFlag(payload, OFF_22, SPD_BAR_TOP, display.digitA);
+            setFlag(payload, OFF_1E, SPD_BAR_BOTTOM, display.digitA);
 
             // Special digits
             if (!showK) {
-                if (displayData.digitA) {
+                if (display.digitA) {
                     drawLetterA(G0, payload, SPD_KILO);
                 }
-                if (displayData.digitB) {
+                if (display.digitB) {
                     drawDigit(G0, payload, SPD_KILO, 8);
                 }
             }
         }
 
         // CAPT CRS: 3 digits
-        if (displayData.showCourse) {
+        if (display.showCourse) {
             int h, t, u;
-            digits3(std::max(0, crsCapt), h, t, u);
+            digits3(std::max(0, display.crsCapt), h, t, u);
             drawDigit(G0, payload, CPT_CRS_HUNDREDS, h);
             drawDigit(G0, payload, CPT_CRS_TENS, t);
             drawDigit(G0, payload, CPT_CRS_UNITS, u);
@@ -301,26 +343,26 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
         }
 
         // HDG: 3 digits - only draw if heading is visible
-        if (displayData.headingVisible) {
+        if (display.headingVisible) {
             int h, t, u;
             // Normalize heading: 360 should display as 360, then wrap to 0
-            int hdg = (heading >= 360) ? 360 : std::clamp(heading, 0, 359);
+            int hdg = (display.heading >= 360) ? 360 : std::clamp(display.heading, 0, 359);
             digits3(hdg, h, t, u);
             drawDigit(G1, payload, HDG_HUNDREDS, h);
             drawDigit(G1, payload, HDG_TENS, t);
             drawDigit(G1, payload, HDG_UNITS, u);
             // No dot for HDG display
             setFlag(payload, OFF_26, DOT_HDG, false);
-            setFlag(payload, OFF_36, LBL_HDG_L, displayData.showLabels && true);
-            setFlag(payload, OFF_32, LBL_HDG_R, displayData.showLabels && true);
-            setFlag(payload, OFF_2E, LBL_TRK_L, displayData.showLabels && false);
-            setFlag(payload, OFF_2A, LBL_TRK_R, displayData.showLabels && false);
+            setFlag(payload, OFF_36, LBL_HDG_L, display.showLabels && true);
+            setFlag(payload, OFF_32, LBL_HDG_R, display.showLabels && true);
+            setFlag(payload, OFF_2E, LBL_TRK_L, display.showLabels && false);
+            setFlag(payload, OFF_2A, LBL_TRK_R, display.showLabels && false);
         }
 
         // ALT: 5 digits
         {
             int d10k, dk, dh, dt, du;
-            digits5(std::max(0, altitude), d10k, dk, dh, dt, du);
+            digits5(std::max(0, display.altitude), d10k, dk, dh, dt, du);
 
             const bool show10k = (d10k != 0);
 
@@ -336,8 +378,8 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
         }
 
         // VVI: sign + 4 digits
-        if (displayData.verticalSpeedVisible) {
-            const int v = static_cast<int>(displayData.verticalSpeed);
+        if (display.verticalSpeedVisible) {
+            const int v = static_cast<int>(display.verticalSpeed);
             const int absV = std::clamp(std::abs(v), 0, 9999);
             int k, h, t, u;
             digits4(absV, k, h, t, u);
@@ -364,24 +406,24 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
             setFlag(payload, OFF_1B, DOT_VSPD, false);
 
             // Show V/S label whenever the display is visible and labels are enabled
-            setFlag(payload, OFF_38, LBL_VS, displayData.showLabels);
+            setFlag(payload, OFF_38, LBL_VS, display.showLabels);
             setFlag(payload, OFF_34, LBL_FPA, false);
-        } else if (displayData.showDashesWhenInactive) {
+        } else if (display.showDashesWhenInactive) {
             // V/S display is inactive - only draw dashes if configured
             drawVviDashes(payload);
             // Show VS label even when inactive if configured
-            if (displayData.showLabelsWhenInactive) {
+            if (display.showLabelsWhenInactive) {
                 setFlag(payload, OFF_38, LBL_VS, true);
             }
-        } else if (displayData.showLabelsWhenInactive) {
+        } else if (display.showLabelsWhenInactive) {
             // Just show the label without dashes
             setFlag(payload, OFF_38, LBL_VS, true);
         }
 
         // FO CRS: 3 digits
-        if (displayData.showCourse) {
+        if (display.showCourse) {
             int h, t, u;
-            digits3(std::max(0, crsFo), h, t, u);
+            digits3(std::max(0, display.crsFo), h, t, u);
             drawDigit(G3, payload, FO_CRS_HUNDREDS, h);
             drawDigit(G3, payload, FO_CRS_TENS, t);
             drawDigit(G3, payload, FO_CRS_UNITS, u);
@@ -390,18 +432,18 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
         }
 
         // Draw dashes for inactive displays if enabled
-        if (displayData.showDashesWhenInactive) {
-            if (!displayData.speedVisible) {
+        if (display.showDashesWhenInactive) {
+            if (!display.speedVisible) {
                 drawSpdDashes(payload);
                 // Show labels even when inactive if configured
-                if (displayData.showLabelsWhenInactive) {
+                if (display.showLabelsWhenInactive) {
                     setFlag(payload, OFF_36, LBL_IAS, true);
                 }
             }
-            if (!displayData.headingVisible) {
+            if (!display.headingVisible) {
                 drawHdgDashes(payload);
                 // Show HDG label even when inactive if configured
-                if (displayData.showLabelsWhenInactive) {
+                if (display.showLabelsWhenInactive) {
                     setFlag(payload, OFF_36, LBL_HDG_L, true);
                     setFlag(payload, OFF_32, LBL_HDG_R, true);
                 }
@@ -455,7 +497,7 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
         data.push_back(0x00);
     }
 
-    writeData(data);
+    writeData(data, changedAt);
     if (++packetNumber == 0) {
         packetNumber = 1;
     }
@@ -468,7 +510,7 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
         emptyFrame[2] = packetNumber;
         emptyFrame[3] = 0x38; // Same opcode
 
-        writeData(emptyFrame);
+        writeData(emptyFrame, changedAt);
         if (++packetNumber == 0) {
             packetNumber = 1;
         }
@@ -490,7 +532,7 @@ void ProductPAP3MCP::sendLCDDisplay(const std::string &speed, int heading, int a
     commitFrame[0x26] = 0xA2;
     commitFrame[0x27] = 0x50;
 
-    writeData(commitFrame);
+    writeData(commitFrame, changedAt);
     if (++packetNumber == 0) {
         packetNumber = 1;
     }
@@ -1,6 +1,8 @@
 #ifndef PRODUCT_PAP3MCP_H
 #define PRODUCT_PAP3MCP_H
 
+#include "aircraft-detector.h"
+#include "display-model.h"
 #include "pap3-mcp-aircraft-profile.h"
 #include "usbdevice.h"
 
@@ -8,21 +10,31 @@
 #include <set>
 #include <vector>
 
+// LCD segment groups, interleaved within the single LCD payload
+enum PAP3MCPDisplayRegion : uint32_t {
+    PAP3_DISPLAY_G0 = 1 << 0,
+    PAP3_DISPLAY_G1 = 1 << 1,
+    PAP3_DISPLAY_G2 = 1 << 2,
+    PAP3_DISPLAY_G3 = 1 << 3,
+    PAP3_DISPLAY_ALL = PAP3_DISPLAY_G0 | PAP3_DISPLAY_G1 | PAP3_DISPLAY_G2 | PAP3_DISPLAY_G3,
+};
+
 class ProductPAP3MCP : public USBDevice {
+    public:
+        static constexpr size_t DisplayFieldCount = 17;
+
     private:
         uint8_t packetNumber = 1;
-        PAP3MCPAircraftProfile *profile;
+        PAP3MCPAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductPAP3MCP, PAP3MCPAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
-        PAP3MCPDisplayData displayData;
+        DisplayModel<PAP3MCPDisplayData, DisplayFieldCount> displayModel;
         int lastUpdateCycle;
-        int displayUpdateFrameCounter = 0;
         std::set<int> pressedButtonIndices;
 
         uint64_t lastButtonStateLo = 0;
         uint32_t lastButtonStateHi = 0;
 
-        void setProfileForCurrentAircraft();
-
     public:
         ProductPAP3MCP(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName);
         ~ProductPAP3MCP();
@@ -31,7 +43,9 @@ class ProductPAP3MCP : public USBDevice {
 
         const char *classIdentifier() override;
         bool connect() override;
-        void update() override;
+        void render() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
@@ -45,7 +59,7 @@ class ProductPAP3MCP : public USBDevice {
 
         void initializeDisplays();
         void clearDisplays();
-        void sendLCDDisplay(const std::string &speed, int heading, int altitude, const std::string &vs, int crsCapt, int crsFo);
+        void sendLCDDisplay(const PAP3MCPDisplayData &display, std::chrono::steady_clock::time_point changedAt = {});
         void sendLCDCommit();
 };
 
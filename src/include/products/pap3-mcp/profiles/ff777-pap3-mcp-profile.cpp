@@ -1,5 +1,6 @@
 #include "ff777-pap3-mcp-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-pap3-mcp.h"
@@ -96,7 +97,7 @@ FF777PAP3MCPProfile::~FF777PAP3MCPProfile() {
 }
 
 bool FF777PAP3MCPProfile::IsEligible() {
-    return Dataref::getInstance()->exists("1-sim/output/mcp/spd");
+    return AircraftDetector::getInstance()->hasDataref("1-sim/output/mcp/spd");
 }
 
 const std::vector<std::string> &FF777PAP3MCPProfile::displayDatarefs() const {
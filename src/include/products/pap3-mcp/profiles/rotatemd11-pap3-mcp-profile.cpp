@@ -1,5 +1,6 @@
 #include "rotatemd11-pap3-mcp-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-pap3-mcp.h"
@@ -53,7 +54,7 @@ RotateMD11PAP3MCPProfile::~RotateMD11PAP3MCPProfile() {
 }
 
 bool RotateMD11PAP3MCPProfile::IsEligible() {
-    return Dataref::getInstance()->exists("Rotate/aircraft/systems/gcp_alt_presel_ft");
+    return AircraftDetector::getInstance()->hasDataref("Rotate/aircraft/systems/gcp_alt_presel_ft");
 }
 
 const std::vector<std::string> &RotateMD11PAP3MCPProfile::displayDatarefs() const {
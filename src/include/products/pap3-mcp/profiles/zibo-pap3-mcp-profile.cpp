@@ -1,5 +1,6 @@
 #include "zibo-pap3-mcp-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-pap3-mcp.h"
@@ -164,7 +165,7 @@ ZiboPAP3MCPProfile::~ZiboPAP3MCPProfile() {
 }
 
 bool ZiboPAP3MCPProfile::IsEligible() {
-    return Dataref::getInstance()->exists("laminar/B738/autopilot/mcp_speed_dial_kts_mach");
+    return AircraftDetector::getInstance()->hasDataref("laminar/B738/autopilot/mcp_speed_dial_kts_mach");
 }
 
 const std::vector<std::string> &ZiboPAP3MCPProfile::displayDatarefs() const {
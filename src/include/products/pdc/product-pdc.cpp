@@ -32,17 +32,40 @@ const char *ProductPDC::classIdentifier() {
     return "PDC";
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductPDC, PDCAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<ZiboPDCProfile>("Zibo 737"),
+    ProfileEntry::make<FF777PDCProfile>("FlightFactor 777"),
+};
+
 void ProductPDC::setProfileForCurrentAircraft() {
-    if (ZiboPDCProfile::IsEligible()) {
-        profile = new ZiboPDCProfile(this);
-        profileReady = true;
-    } else if (FF777PDCProfile::IsEligible()) {
-        profile = new FF777PDCProfile(this);
-        profileReady = true;
-    } else {
-        profile = nullptr;
-        profileReady = false;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
     }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+}
+
+void ProductPDC::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
+    }
+
+    delete profile;
+    profile = nullptr;
 }
 
 bool ProductPDC::connect() {
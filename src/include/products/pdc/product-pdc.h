@@ -1,6 +1,7 @@
 #ifndef PRODUCT_PDC_H
 #define PRODUCT_PDC_H
 
+#include "aircraft-detector.h"
 #include "pdc-aircraft-profile.h"
 #include "usbdevice.h"
 
@@ -12,14 +13,13 @@ enum class PDCLed : int {
 
 class ProductPDC : public USBDevice {
     private:
-        PDCAircraftProfile *profile;
+        PDCAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductPDC, PDCAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
         uint64_t lastButtonStateLo;
         uint32_t lastButtonStateHi;
         std::set<int> pressedButtonIndices;
 
-        void setProfileForCurrentAircraft();
-
     public:
         ProductPDC(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName, PDCDeviceVariant variant, unsigned char identifierByte);
         ~ProductPDC();
@@ -29,6 +29,8 @@ class ProductPDC : public USBDevice {
 
         const char *classIdentifier() override;
         bool connect() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
@@ -1,5 +1,6 @@
 #include "ff777-pdc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-pdc.h"
@@ -39,8 +40,8 @@ FF777PDCProfile::~FF777PDCProfile() {
 
 bool FF777PDCProfile::IsEligible() {
     // FF777 datarefs that don't exist on the FF767
-    return Dataref::getInstance()->exists("1-sim/ckpt/mcpApLButton/anim") &&
-           Dataref::getInstance()->exists("1-sim/output/mcp/ok");
+    return AircraftDetector::getInstance()->hasDataref("1-sim/ckpt/mcpApLButton/anim") &&
+           AircraftDetector::getInstance()->hasDataref("1-sim/output/mcp/ok");
 }
 
 const std::unordered_map<PDCButtonIndex3N3M, PDCButtonDef> &FF777PDCProfile::buttonDefs() const {
@@ -1,5 +1,6 @@
 #include "zibo-pdc-profile.h"
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "dataref.h"
 #include "product-pdc.h"
@@ -43,7 +44,7 @@ ZiboPDCProfile::~ZiboPDCProfile() {
 }
 
 bool ZiboPDCProfile::IsEligible() {
-    return Dataref::getInstance()->exists("laminar/B738/autopilot/mcp_speed_dial_kts_mach");
+    return AircraftDetector::getInstance()->hasDataref("laminar/B738/autopilot/mcp_speed_dial_kts_mach");
 }
 
 const std::unordered_map<PDCButtonIndex3N3M, PDCButtonDef> &ZiboPDCProfile::buttonDefs() const {
@@ -2,7 +2,9 @@
 
 #include "appstate.h"
 #include "dataref.h"
+#include "haptics-engine.h"
 #include "plugins-menu.h"
+#include "preferences.h"
 #include "profiles/toliss-ursa-minor-joystick-profile.h"
 #include "profiles/zibo-ursa-minor-joystick-profile.h"
 
@@ -14,6 +16,8 @@ ProductUrsaMinorJoystick::ProductUrsaMinorJoystick(HIDDeviceHandle hidDevice, ui
 }
 
 ProductUrsaMinorJoystick::~ProductUrsaMinorJoystick() {
+    HapticsEngine::getInstance()->removeOutput(this);
+    Preferences::getInstance()->removeObservers(this);
     blackout();
 
     PluginsMenu::getInstance()->removeItem(menuItemId);
@@ -28,17 +32,48 @@ const char *ProductUrsaMinorJoystick::classIdentifier() {
     return "Ursa Minor Joystick";
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductUrsaMinorJoystick, UrsaMinorJoystickAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<TolissUrsaMinorJoystickProfile>("Toliss"),
+    ProfileEntry::make<ZiboUrsaMinorJoystickProfile>("Zibo 737"),
+};
+
 void ProductUrsaMinorJoystick::setProfileForCurrentAircraft() {
-    if (TolissUrsaMinorJoystickProfile::IsEligible()) {
-        profile = new TolissUrsaMinorJoystickProfile(this);
-        profileReady = true;
-    } else if (ZiboUrsaMinorJoystickProfile::IsEligible()) {
-        profile = new ZiboUrsaMinorJoystickProfile(this);
-        profileReady = true;
-    } else {
-        profile = nullptr;
-        profileReady = false;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
+    }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
     }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+
+    HapticsEngine::getInstance()->addOutput(this, [this](float level) {
+        setVibrationLevel(level);
+    });
+}
+
+void ProductUrsaMinorJoystick::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
+    }
+
+    HapticsEngine::getInstance()->removeOutput(this);
+    delete profile;
+    profile = nullptr;
+
+    lastVibration = 0;
+    setVibration(0);
 }
 
 bool ProductUrsaMinorJoystick::connect() {
@@ -56,6 +91,13 @@ bool ProductUrsaMinorJoystick::connect() {
 
     std::string lightingSetting = AppState::getInstance()->readPreference("JoystickLighting", "enabled");
 
+    Preferences::getInstance()->observe(this, "JoystickVibration", [this](const std::string &value) {
+        loadVibrationSetting(value);
+    });
+    Preferences::getInstance()->observe(this, "JoystickLighting", [this](const std::string &value) {
+        setLedBrightness(value == "disabled" ? 0 : 128);
+    });
+
     menuItemId = PluginsMenu::getInstance()->addItem(
         classIdentifier(),
         std::vector<MenuItem>{
@@ -71,19 +113,16 @@ bool ProductUrsaMinorJoystick::connect() {
 
                                       {.name = "Disabled", .checked = vibrationSetting == "disabled", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("JoystickVibration", "disabled");
-                                           loadVibrationSetting("disabled");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
                                       {.name = "Normal", .checked = vibrationSetting == "normal", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("JoystickVibration", "normal");
-                                           loadVibrationSetting("normal");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
                                       {.name = "Strong", .checked = vibrationSetting == "strong", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("JoystickVibration", "strong");
-                                           loadVibrationSetting("strong");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
@@ -93,13 +132,11 @@ bool ProductUrsaMinorJoystick::connect() {
 
                                      {.name = "Disabled", .checked = lightingSetting == "disabled", .content = [this](int itemId) {
                                           AppState::getInstance()->writePreference("JoystickLighting", "disabled");
-                                          setLedBrightness(0);
                                           PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                           PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                       }},
                                      {.name = "Enabled", .checked = lightingSetting == "enabled", .content = [this](int itemId) {
                                           AppState::getInstance()->writePreference("JoystickLighting", "enabled");
-                                          setLedBrightness(128);
                                           PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                           PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                       }}}},
@@ -113,24 +150,29 @@ void ProductUrsaMinorJoystick::blackout() {
     setVibration(0);
 }
 
-void ProductUrsaMinorJoystick::update() {
-    if (!connected) {
+void ProductUrsaMinorJoystick::setVibration(uint8_t vibration) {
+    if (vibrationMultiplier <= std::numeric_limits<float>::epsilon()) {
         return;
     }
 
-    USBDevice::update();
-
-    if (profile) {
-        profile->update();
-    }
+    // Also written from the haptics thread, which must not read the main thread's latency origin
+    writeData({0x02, identifierByte, 0xBF, 0x00, 0x00, 0x03, 0x49, 0x00, vibration, 0x00, 0x00, 0x00, 0x00, 0x00}, LatencyTracker::Clock::time_point{});
 }
 
-void ProductUrsaMinorJoystick::setVibration(uint8_t vibration) {
-    if (vibrationMultiplier <= std::numeric_limits<float>::epsilon()) {
+void ProductUrsaMinorJoystick::setVibrationLevel(float level) {
+    if (!connected) {
         return;
     }
 
-    writeData({0x02, identifierByte, 0xBF, 0x00, 0x00, 0x03, 0x49, 0x00, vibration, 0x00, 0x00, 0x00, 0x00, 0x00});
+    uint8_t vibration = (uint8_t) std::min(255.0f, level * vibrationMultiplier);
+    if (vibration < 6) {
+        vibration = 0;
+    }
+
+    if (vibration != lastVibration) {
+        setVibration(vibration);
+        lastVibration = vibration;
+    }
 }
 
 void ProductUrsaMinorJoystick::setLedBrightness(uint8_t brightness) {
@@ -1,15 +1,19 @@
 #ifndef PRODUCT_URSA_MINOR_JOYSTICK_H
 #define PRODUCT_URSA_MINOR_JOYSTICK_H
 
+#include "aircraft-detector.h"
 #include "ursa-minor-joystick-aircraft-profile.h"
 #include "usbdevice.h"
 
+#include <atomic>
+
 class ProductUrsaMinorJoystick : public USBDevice {
     private:
-        UrsaMinorJoystickAircraftProfile *profile;
+        UrsaMinorJoystickAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductUrsaMinorJoystick, UrsaMinorJoystickAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
+        uint8_t lastVibration = 0;
 
-        void setProfileForCurrentAircraft();
         void loadVibrationSetting(const std::string &preference);
 
     public:
@@ -17,14 +21,16 @@ class ProductUrsaMinorJoystick : public USBDevice {
         ~ProductUrsaMinorJoystick();
 
         const unsigned char identifierByte;
-        float vibrationMultiplier;
+        std::atomic<float> vibrationMultiplier;
 
         const char *classIdentifier() override;
         bool connect() override;
-        void update() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
 
         void setVibration(uint8_t vibration);
+        void setVibrationLevel(float level);
         void setLedBrightness(uint8_t brightness);
 };
 
@@ -6,17 +6,11 @@
 #include <string>
 
 class ZiboUrsaMinorJoystickProfile : public UrsaMinorJoystickAircraftProfile {
-    private:
-        int lastVibration = 0;
-        float lastGForce = 0.0f;
-
     public:
         ZiboUrsaMinorJoystickProfile(ProductUrsaMinorJoystick *product);
         ~ZiboUrsaMinorJoystickProfile();
 
         static bool IsEligible();
-
-        void update() override;
 };
 
 #endif
@@ -13,8 +13,6 @@ class UrsaMinorJoystickAircraftProfile {
     public:
         UrsaMinorJoystickAircraftProfile(ProductUrsaMinorJoystick *product) : product(product) {};
         virtual ~UrsaMinorJoystickAircraftProfile() = default;
-
-        virtual void update() = 0;
 };
 
 #endif
@@ -2,7 +2,9 @@
 
 #include "appstate.h"
 #include "dataref.h"
+#include "haptics-engine.h"
 #include "plugins-menu.h"
+#include "preferences.h"
 #include "profiles/toliss-ursa-minor-throttle-profile.h"
 #include "segment-display.h"
 
@@ -18,6 +20,8 @@ ProductUrsaMinorThrottle::ProductUrsaMinorThrottle(HIDDeviceHandle hidDevice, ui
 }
 
 ProductUrsaMinorThrottle::~ProductUrsaMinorThrottle() {
+    HapticsEngine::getInstance()->removeOutput(this);
+    Preferences::getInstance()->removeObservers(this);
     blackout();
 
     PluginsMenu::getInstance()->removeItem(menuItemId);
@@ -32,14 +36,48 @@ const char *ProductUrsaMinorThrottle::classIdentifier() {
     return "Ursa Minor Throttle";
 }
 
+using ProfileEntry = AircraftProfileEntry<ProductUrsaMinorThrottle, UrsaMinorThrottleAircraftProfile>;
+
+static const std::vector<ProfileEntry> profileRegistry = {
+    ProfileEntry::make<TolissUrsaMinorThrottleProfile>("Toliss"),
+};
+
 void ProductUrsaMinorThrottle::setProfileForCurrentAircraft() {
-    if (TolissUrsaMinorThrottleProfile::IsEligible()) {
-        profile = new TolissUrsaMinorThrottleProfile(this);
-        profileReady = true;
-    } else {
-        profile = nullptr;
-        profileReady = false;
+    const ProfileEntry *entry = AircraftDetector::getInstance()->match(profileRegistry);
+    if (profile && entry == profileEntry) {
+        return;
     }
+
+    unloadProfile();
+    profileEntry = entry;
+    if (!entry) {
+        return;
+    }
+
+    debug("%s: using %s profile\n", classIdentifier(), entry->name);
+    profile = entry->create(this);
+    profileReady = true;
+
+    HapticsEngine::getInstance()->addOutput(this, [this](float level) {
+        setVibrationLevel(level);
+    });
+}
+
+void ProductUrsaMinorThrottle::unloadProfile() {
+    profileReady = false;
+    profileEntry = nullptr;
+
+    if (!profile) {
+        return;
+    }
+
+    HapticsEngine::getInstance()->removeOutput(this);
+    delete profile;
+    profile = nullptr;
+
+    setAllLedsEnabled(false);
+    lastVibration = 0;
+    setVibration(0);
 }
 
 bool ProductUrsaMinorThrottle::connect() {
@@ -56,6 +94,10 @@ bool ProductUrsaMinorThrottle::connect() {
     std::string vibrationPreference = AppState::getInstance()->readPreference("ThrottleVibration", "disabled"); // For the throttle, we disable vibration by default.
     loadVibrationSetting(vibrationPreference);
 
+    Preferences::getInstance()->observe(this, "ThrottleVibration", [this](const std::string &value) {
+        loadVibrationSetting(value);
+    });
+
     menuItemId = PluginsMenu::getInstance()->addItem(
         classIdentifier(),
         std::vector<MenuItem>{
@@ -71,19 +113,16 @@ bool ProductUrsaMinorThrottle::connect() {
 
                                       {.name = "Disabled", .checked = vibrationPreference == "disabled", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("ThrottleVibration", "disabled");
-                                           loadVibrationSetting("disabled");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
                                       {.name = "Normal", .checked = vibrationPreference == "normal", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("ThrottleVibration", "normal");
-                                           loadVibrationSetting("normal");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
                                       {.name = "Strong", .checked = vibrationPreference == "strong", .content = [this](int itemId) {
                                            AppState::getInstance()->writePreference("ThrottleVibration", "strong");
-                                           loadVibrationSetting("strong");
                                            PluginsMenu::getInstance()->uncheckSubmenuSiblings(itemId);
                                            PluginsMenu::getInstance()->setItemChecked(itemId, true);
                                        }},
@@ -100,21 +139,6 @@ void ProductUrsaMinorThrottle::blackout() {
     setAllLedsEnabled(false);
 }
 
-void ProductUrsaMinorThrottle::update() {
-    if (!connected) {
-        return;
-    }
-
-    USBDevice::update();
-
-    if (profile) {
-        profile->update();
-
-        // We explicity do not want an auto update, we simply listen for the dataref and only then update.
-        // profile->updateDisplays();
-    }
-}
-
 void ProductUrsaMinorThrottle::setAllLedsEnabled(bool enable) {
     unsigned char start = static_cast<unsigned char>(UrsaMinorThrottleLed::_START);
     unsigned char end = static_cast<unsigned char>(UrsaMinorThrottleLed::_END);
@@ -138,12 +162,29 @@ void ProductUrsaMinorThrottle::setVibration(uint8_t vibration, bool leftSide, bo
         return;
     }
 
+    // Also written from the haptics thread, which must not read the main thread's latency origin
     if (leftSide) {
-        writeData({0x02, ProductUrsaMinorThrottle::ThrottleIdentifierByte, 0xB9, 0x00, 0x00, 0x03, 0x49, 0x0E, vibration, 0x00, 0x00, 0x00, 0x00, 0x00});
+        writeData({0x02, ProductUrsaMinorThrottle::ThrottleIdentifierByte, 0xB9, 0x00, 0x00, 0x03, 0x49, 0x0E, vibration, 0x00, 0x00, 0x00, 0x00, 0x00}, LatencyTracker::Clock::time_point{});
     }
 
     if (rightSide) {
-        writeData({0x02, ProductUrsaMinorThrottle::ThrottleIdentifierByte, 0xB9, 0x00, 0x00, 0x03, 0x49, 0x10, vibration, 0x00, 0x00, 0x00, 0x00, 0x00});
+        writeData({0x02, ProductUrsaMinorThrottle::ThrottleIdentifierByte, 0xB9, 0x00, 0x00, 0x03, 0x49, 0x10, vibration, 0x00, 0x00, 0x00, 0x00, 0x00}, LatencyTracker::Clock::time_point{});
+    }
+}
+
+void ProductUrsaMinorThrottle::setVibrationLevel(float level) {
+    if (!connected) {
+        return;
+    }
+
+    uint8_t vibration = (uint8_t) std::min(255.0f, level * vibrationMultiplier);
+    if (vibration < 6) {
+        vibration = 0;
+    }
+
+    if (vibration != lastVibration) {
+        setVibration(vibration);
+        lastVibration = vibration;
     }
 }
 
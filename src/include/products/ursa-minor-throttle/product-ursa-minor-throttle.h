@@ -1,9 +1,11 @@
 #ifndef PRODUCT_URSA_MINOR_THROTTLE_H
 #define PRODUCT_URSA_MINOR_THROTTLE_H
 
+#include "aircraft-detector.h"
 #include "ursa-minor-throttle-aircraft-profile.h"
 #include "usbdevice.h"
 
+#include <atomic>
 #include <set>
 
 enum class UrsaMinorThrottleLed : int {
@@ -20,14 +22,15 @@ enum class UrsaMinorThrottleLed : int {
 
 class ProductUrsaMinorThrottle : public USBDevice {
     private:
-        UrsaMinorThrottleAircraftProfile *profile;
+        UrsaMinorThrottleAircraftProfile *profile = nullptr;
+        const AircraftProfileEntry<ProductUrsaMinorThrottle, UrsaMinorThrottleAircraftProfile> *profileEntry = nullptr;
         int menuItemId;
         uint64_t lastButtonStateLo;
         uint32_t lastButtonStateHi;
         std::set<int> pressedButtonIndices;
         uint8_t packetNumber = 1;
+        uint8_t lastVibration = 0;
 
-        void setProfileForCurrentAircraft();
         void loadVibrationSetting(const std::string &preference);
 
     public:
@@ -36,11 +39,12 @@ class ProductUrsaMinorThrottle : public USBDevice {
 
         static constexpr unsigned char ThrottleIdentifierByte = 0x10;
         static constexpr unsigned char PACIdentifierByte = 0x01;
-        float vibrationMultiplier;
+        std::atomic<float> vibrationMultiplier;
 
         const char *classIdentifier() override;
         bool connect() override;
-        void update() override;
+        void setProfileForCurrentAircraft() override;
+        void unloadProfile() override;
         void blackout() override;
         void didReceiveData(int reportId, uint8_t *report, int reportLength) override;
         void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1) override;
@@ -49,6 +53,7 @@ class ProductUrsaMinorThrottle : public USBDevice {
         void setAllLedsEnabled(bool enabled);
         void setLedBrightness(UrsaMinorThrottleLed led, uint8_t brightness);
         void setVibration(uint8_t vibration, bool leftSide = true, bool rightSide = true);
+        void setVibrationLevel(float level);
         void setLCDText(const std::string &text);
 };
 
@@ -0,0 +1,103 @@
+#include "aircraft-detector.h"
+
+#include "appstate.h"
+#include "config.h"
+#include "dataref.h"
+#include "usbcontroller.h"
+
+#include <XPLMDataAccess.h>
+
+AircraftDetector *AircraftDetector::instance = nullptr;
+
+AircraftDetector::AircraftDetector() {
+    currentSignature = {};
+    probedDatarefs = {};
+    registryMatches = {};
+}
+
+AircraftDetector::~AircraftDetector() {
+    instance = nullptr;
+}
+
+AircraftDetector *AircraftDetector::getInstance() {
+    if (instance == nullptr) {
+        instance = new AircraftDetector();
+    }
+
+    return instance;
+}
+
+void AircraftDetector::planeLoaded() {
+    probedDatarefs.clear();
+    registryMatches.clear();
+    currentSignature = readSignature();
+
+    debug_force("Detected aircraft (ICAO: %s, author: %s)\n", currentSignature.icao.c_str(), currentSignature.author.c_str());
+    notifyDevices();
+}
+
+void AircraftDetector::planeUnloaded() {
+    probedDatarefs.clear();
+    registryMatches.clear();
+    currentSignature = {};
+}
+
+void AircraftDetector::datarefsAdded() {
+    // Aircraft plugins register their datarefs in bursts while loading
+    AppState::getInstance()->executeAfterDebounced("AircraftDetector::recheck", 500, [this]() {
+        recheck();
+    });
+}
+
+void AircraftDetector::recheck() {
+    bool changed = false;
+
+    for (auto &[ref, found] : probedDatarefs) {
+        if (!found && XPLMFindDataRef(ref.c_str())) {
+            found = true;
+            changed = true;
+        }
+    }
+
+    AircraftSignature signature = readSignature();
+    if (signature != currentSignature) {
+        currentSignature = signature;
+        changed = true;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    debug("Aircraft datarefs changed, re-evaluating profiles (ICAO: %s)\n", currentSignature.icao.c_str());
+    registryMatches.clear();
+    notifyDevices();
+}
+
+void AircraftDetector::notifyDevices() {
+    for (auto *device : USBController::getInstance()->devices) {
+        device->setProfileForCurrentAircraft();
+    }
+}
+
+AircraftSignature AircraftDetector::readSignature() {
+    return {
+        .icao = Dataref::getInstance()->get<std::string>("sim/aircraft/view/acf_ICAO"),
+        .author = Dataref::getInstance()->get<std::string>("sim/aircraft/view/acf_author"),
+    };
+}
+
+bool AircraftDetector::hasDataref(const char *ref) {
+    auto it = probedDatarefs.find(ref);
+    if (it != probedDatarefs.end()) {
+        return it->second;
+    }
+
+    bool found = XPLMFindDataRef(ref) != nullptr;
+    probedDatarefs.emplace(ref, found);
+    return found;
+}
+
+const AircraftSignature &AircraftDetector::signature() const {
+    return currentSignature;
+}
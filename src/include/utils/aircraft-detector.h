@@ -0,0 +1,73 @@
+#ifndef AIRCRAFT_DETECTOR_H
+#define AIRCRAFT_DETECTOR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct AircraftSignature {
+        std::string icao;
+        std::string author;
+
+        bool operator==(const AircraftSignature &other) const = default;
+};
+
+template<typename ProductT, typename ProfileT>
+struct AircraftProfileEntry {
+        const char *name;
+        bool (*isEligible)();
+        ProfileT *(*create)(ProductT *product);
+
+        template<typename ConcreteT>
+        static AircraftProfileEntry make(const char *name) {
+            return {name, &ConcreteT::IsEligible, [](ProductT *product) -> ProfileT * {
+                        return new ConcreteT(product);
+                    }};
+        }
+};
+
+class AircraftDetector {
+    private:
+        AircraftDetector();
+        ~AircraftDetector();
+        static AircraftDetector *instance;
+
+        AircraftSignature currentSignature;
+        std::unordered_map<std::string, bool> probedDatarefs;
+        std::unordered_map<const void *, int> registryMatches;
+
+        AircraftSignature readSignature();
+        void recheck();
+        void notifyDevices();
+
+    public:
+        static AircraftDetector *getInstance();
+
+        void planeLoaded();
+        void planeUnloaded();
+        void datarefsAdded();
+
+        bool hasDataref(const char *ref);
+        const AircraftSignature &signature() const;
+
+        // Evaluates a product's profile registry once per detected aircraft, first eligible entry wins
+        template<typename EntryT>
+        const EntryT *match(const std::vector<EntryT> &registry) {
+            auto it = registryMatches.find(&registry);
+            if (it == registryMatches.end()) {
+                int index = -1;
+                for (size_t i = 0; i < registry.size(); i++) {
+                    if (registry[i].isEligible()) {
+                        index = static_cast<int>(i);
+                        break;
+                    }
+                }
+
+                it = registryMatches.emplace(&registry, index).first;
+            }
+
+            return it->second >= 0 ? &registry[it->second] : nullptr;
+        }
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include "dataref-profiler.h"
+
+#include "appstate.h"
+#include "config.h"
+
+#include <algorithm>
+#include <fstream>
+#include <XPLMUtilities.h>
+
+DatarefProfiler *DatarefProfiler::instance = nullptr;
+
+DatarefProfiler::DatarefProfiler() {
+    caller = CallerOther;
+    refs = {};
+}
+
+DatarefProfiler::~DatarefProfiler() {
+    instance = nullptr;
+}
+
+DatarefProfiler *DatarefProfiler::getInstance() {
+    if (instance == nullptr) {
+        instance = new DatarefProfiler();
+    }
+
+    return instance;
+}
+
+DatarefProfiler::Scope::Scope(const char *caller) {
+    DatarefProfiler *profiler = DatarefProfiler::getInstance();
+    previous = profiler->caller;
+    profiler->caller = caller;
+}
+
+DatarefProfiler::Scope::~Scope() {
+    DatarefProfiler::getInstance()->caller = previous;
+}
+
+void DatarefProfiler::setEnabled(bool enabled) {
+    if (enabled && !this->enabled) {
+        reset();
+    }
+
+    this->enabled = enabled;
+}
+
+void DatarefProfiler::reset() {
+    refs.clear();
+    enabledAt = std::chrono::steady_clock::now();
+}
+
+DatarefAccessStats &DatarefProfiler::statsFor(const char *ref) {
+    auto it = refs.find(std::string_view(ref));
+    if (it == refs.end()) {
+        it = refs.emplace(ref, CallerStats{}).first;
+    }
+
+    CallerStats &callers = it->second;
+    for (auto &[name, stats] : callers) {
+        if (name == caller) {
+            return stats;
+        }
+    }
+
+    return callers.emplace_back(caller, DatarefAccessStats{}).second;
+}
+
+void DatarefProfiler::recordRead(const char *ref, size_t bytes, std::chrono::steady_clock::duration elapsed) {
+    if (!enabled) {
+        return;
+    }
+
+    DatarefAccessStats &stats = statsFor(ref);
+    stats.reads++;
+    stats.bytesRead += bytes;
+    stats.accessorTime += elapsed;
+}
+
+void DatarefProfiler::recordWrite(const char *ref, size_t bytes, std::chrono::steady_clock::duration elapsed) {
+    if (!enabled) {
+        return;
+    }
+
+    DatarefAccessStats &stats = statsFor(ref);
+    stats.writes++;
+    stats.bytesWritten += bytes;
+    stats.accessorTime += elapsed;
+}
+
+void DatarefProfiler::recordCacheLookup(const char *ref, bool hit) {
+    if (!enabled) {
+        return;
+    }
+
+    DatarefAccessStats &stats = statsFor(ref);
+    if (hit) {
+        stats.cacheHits++;
+    } else {
+        stats.cacheMisses++;
+    }
+}
+
+void DatarefProfiler::recordChange(const char *ref) {
+    if (!enabled) {
+        return;
+    }
+
+    statsFor(ref).changes++;
+}
+
+void DatarefProfiler::recordCallback(const char *ref) {
+    if (!enabled) {
+        return;
+    }
+
+    statsFor(ref).callbacks++;
+}
+
+std::vector<DatarefProfileRow> DatarefProfiler::snapshot() const {
+    std::vector<DatarefProfileRow> rows;
+    for (const auto &[ref, callers] : refs) {
+        for (const auto &[name, stats] : callers) {
+            rows.push_back({.ref = ref, .caller = name, .stats = stats});
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](const DatarefProfileRow &a, const DatarefProfileRow &b) {
+        if (a.stats.accessorTime != b.stats.accessorTime) {
+            return a.stats.accessorTime > b.stats.accessorTime;
+        }
+
+        return a.stats.reads + a.stats.writes > b.stats.reads + b.stats.writes;
+    });
+
+    return rows;
+}
+
+float DatarefProfiler::secondsProfiled() const {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - enabledAt).count();
+}
+
+static std::string jsonEscape(const std::string &value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+bool DatarefProfiler::exportSnapshot() {
+    std::vector<DatarefProfileRow> rows = snapshot();
+    float seconds = std::max(secondsProfiled(), 0.001f);
+    std::string directory = AppState::getInstance()->getPluginDirectory();
+
+    std::ofstream csv(directory + "/dataref-profile.csv");
+    std::ofstream json(directory + "/dataref-profile.json");
+    if (!csv.is_open() || !json.is_open()) {
+        debug_force("Failed to write the dataref profile to %s\n", directory.c_str());
+        return false;
+    }
+
+    csv << "ref,caller,reads,writes,bytes_read,bytes_written,accessor_ms,cache_hits,cache_misses,cache_hit_ratio,changes,changes_per_second,callbacks\n";
+    json << "{\n  \"seconds\": " << seconds << ",\n  \"refs\": [";
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        const DatarefAccessStats &stats = rows[i].stats;
+        double accessorMs = std::chrono::duration<double, std::milli>(stats.accessorTime).count();
+        uint64_t lookups = stats.cacheHits + stats.cacheMisses;
+        double hitRatio = lookups > 0 ? (double) stats.cacheHits / lookups : 0.0;
+        double changesPerSecond = stats.changes / seconds;
+
+        csv << rows[i].ref << "," << rows[i].caller << "," << stats.reads << "," << stats.writes << "," << stats.bytesRead << "," << stats.bytesWritten << ","
+            << accessorMs << "," << stats.cacheHits << "," << stats.cacheMisses << "," << hitRatio << "," << stats.changes << "," << changesPerSecond << "," << stats.callbacks << "\n";
+
+        json << (i > 0 ? "," : "") << "\n    {\"ref\": \"" << jsonEscape(rows[i].ref) << "\", \"caller\": \"" << jsonEscape(rows[i].caller) << "\""
+             << ", \"reads\": " << stats.reads << ", \"writes\": " << stats.writes
+             << ", \"bytesRead\": " << stats.bytesRead << ", \"bytesWritten\": " << stats.bytesWritten
+             << ", \"accessorMs\": " << accessorMs
+             << ", \"cacheHits\": " << stats.cacheHits << ", \"cacheMisses\": " << stats.cacheMisses << ", \"cacheHitRatio\": " << hitRatio
+             << ", \"changes\": " << stats.changes << ", \"changesPerSecond\": " << changesPerSecond
+             << ", \"callbacks\": " << stats.callbacks << "}";
+    }
+
+    json << "\n  ]\n}\n";
+
+    debug_force("Wrote the dataref profile (%zu rows, %.0f seconds) to %s\n", rows.size(), seconds, directory.c_str());
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef DATAREF_PROFILER_H
+#define DATAREF_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct DatarefAccessStats {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t cacheHits = 0;
+        uint64_t cacheMisses = 0;
+        uint64_t changes = 0;
+        uint64_t callbacks = 0;
+        std::chrono::steady_clock::duration accessorTime = std::chrono::steady_clock::duration::zero();
+};
+
+struct DatarefProfileRow {
+        std::string ref;
+        const char *caller;
+        DatarefAccessStats stats;
+};
+
+// Attributes dataref traffic to a ref and to the caller that is active, e.g. the device being rendered.
+// Main thread only, like the XPLM dataref API itself. While disabled every hook is a single branch.
+class DatarefProfiler {
+    private:
+        DatarefProfiler();
+        ~DatarefProfiler();
+        static DatarefProfiler *instance;
+
+        // Callers are string literals, so they are compared by pointer
+        using CallerStats = std::vector<std::pair<const char *, DatarefAccessStats>>;
+
+        // Lets refs be looked up by the const char * name without building a std::string per access
+        struct RefHash {
+                using is_transparent = void;
+
+                size_t operator()(std::string_view ref) const {
+                    return std::hash<std::string_view>{}(ref);
+                }
+        };
+
+        bool enabled = false;
+        const char *caller;
+        std::chrono::steady_clock::time_point enabledAt;
+        std::unordered_map<std::string, CallerStats, RefHash, std::equal_to<>> refs;
+
+        DatarefAccessStats &statsFor(const char *ref);
+
+    public:
+        static constexpr const char *CallerCacheRefresh = "cache refresh";
+        static constexpr const char *CallerOther = "other";
+
+        // Sets the caller for its lifetime, restoring the previous one afterwards
+        class Scope {
+            public:
+                explicit Scope(const char *caller);
+                ~Scope();
+                Scope(const Scope &) = delete;
+                Scope &operator=(const Scope &) = delete;
+
+            private:
+                const char *previous;
+        };
+
+        static DatarefProfiler *getInstance();
+
+        bool isEnabled() const {
+            return enabled;
+        }
+
+        void setEnabled(bool enabled);
+        void reset();
+
+        void recordRead(const char *ref, size_t bytes, std::chrono::steady_clock::duration elapsed);
+        void recordWrite(const char *ref, size_t bytes, std::chrono::steady_clock::duration elapsed);
+        void recordCacheLookup(const char *ref, bool hit);
+        void recordChange(const char *ref);
+        void recordCallback(const char *ref);
+
+        // Rows sorted by time spent in XPLM accessors, most expensive first
+        std::vector<DatarefProfileRow> snapshot() const;
+        float secondsProfiled() const;
+
+        // Writes dataref-profile.csv and dataref-profile.json into the plugin directory
+        bool exportSnapshot();
+};
+
+#endif
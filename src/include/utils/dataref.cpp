@@ -2,6 +2,8 @@
 
 #include "appstate.h"
 #include "config.h"
+#include "dataref-profiler.h"
+#include "latency-tracker.h"
 
 #include <cmath>
 #include <cstring>
@@ -12,7 +14,6 @@
 using namespace std;
 
 Dataref *Dataref::instance = nullptr;
-static std::unordered_map<std::string, uint64_t> debugAccessStats;
 
 int handleCommandCallback(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon) {
     return Dataref::getInstance()->_commandCallback(inCommand, inPhase, inRefcon);
@@ -268,11 +269,21 @@ void Dataref::unbind(const char *ref) {
     //    cachedValues.erase(ref);
 }
 
+void Dataref::unbind(const char *ref, const void *valuePointer) {
+    auto it = boundRefs.find(ref);
+    if (it == boundRefs.end() || it->second.valuePointer != valuePointer) {
+        return;
+    }
+
+    unbind(ref);
+}
+
 void Dataref::clearCache() {
     cachedValues.clear();
 }
 
 void Dataref::update() {
+    DatarefProfiler::Scope profilerScope(DatarefProfiler::CallerCacheRefresh);
     std::vector<std::pair<std::string, CachedValue>> updates;
 
     for (auto &[key, data] : cachedValues) {
@@ -287,6 +298,7 @@ void Dataref::update() {
             }
 
             if (didChange) {
+                DatarefProfiler::getInstance()->recordChange(key.c_str());
                 updates.emplace_back(key, CachedValue{
                                               .value = newValue,
                                               .lastUpdateCycleNumber = XPLMGetCycleNumber(),
@@ -296,10 +308,17 @@ void Dataref::update() {
             data.value);
     }
 
+    if (updates.empty()) {
+        return;
+    }
+
+    LatencyTracker::markDatarefChange();
+    LatencyTracker::setDispatchingDatarefChange(true);
     for (auto &[key, newData] : updates) {
         cachedValues[key] = newData;
         executeChangedCallbacksForDataref(key.c_str());
     }
+    LatencyTracker::setDispatchingDatarefChange(false);
 }
 
 XPLMDataRef Dataref::findRef(const char *ref) {
@@ -323,9 +342,7 @@ bool Dataref::exists(const char *ref) {
 void Dataref::executeChangedCallbacksForDataref(const char *ref) {
     auto it = boundRefs.find(ref);
     if (it != boundRefs.end()) {
-        if (AppState::getInstance()->debuggingEnabled) {
-            debugAccessStats[ref]++;
-        }
+        DatarefProfiler::getInstance()->recordCallback(ref);
 
         for (auto callback : boundRefs[ref].changeCallbacks) {
             callback(cachedValues[ref].value);
@@ -354,6 +371,7 @@ template std::string Dataref::getCached<std::string>(const char *ref);
 template<typename T>
 T Dataref::getCached(const char *ref) {
     auto it = cachedValues.find(ref);
+    DatarefProfiler::getInstance()->recordCacheLookup(ref, it != cachedValues.end());
     if (it == cachedValues.end()) {
         auto val = get<T>(ref);
         cachedValues[ref] = {
@@ -385,6 +403,17 @@ T Dataref::getCached(const char *ref) {
     return std::get<T>(it->second.value);
 }
 
+template<typename T>
+static size_t byteSize(const T &value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else if constexpr (std::is_same_v<T, std::vector<int>> || std::is_same_v<T, std::vector<float>> || std::is_same_v<T, std::vector<unsigned char>>) {
+        return value.size() * sizeof(typename T::value_type);
+    } else {
+        return sizeof(T);
+    }
+}
+
 template float Dataref::get<float>(const char *ref);
 template double Dataref::get<double>(const char *ref);
 template int Dataref::get<int>(const char *ref);
@@ -407,6 +436,18 @@ T Dataref::get(const char *ref) {
         }
     }
 
+    if (!DatarefProfiler::getInstance()->isEnabled()) {
+        return read<T>(handle);
+    }
+
+    auto startedAt = std::chrono::steady_clock::now();
+    T value = read<T>(handle);
+    DatarefProfiler::getInstance()->recordRead(ref, byteSize(value), std::chrono::steady_clock::now() - startedAt);
+    return value;
+}
+
+template<typename T>
+T Dataref::read(XPLMDataRef handle) {
     if constexpr (std::is_same_v<T, bool>) {
         XPLMDataTypeID refType = XPLMGetDataRefTypes(handle);
         if ((refType & xplmType_Float) == xplmType_Float) {
@@ -484,6 +525,20 @@ void Dataref::set(const char *ref, T value, bool setCacheOnly) {
         return;
     }
 
+    LatencyTracker::markCommand();
+
+    if (!DatarefProfiler::getInstance()->isEnabled()) {
+        write<T>(handle, value);
+        return;
+    }
+
+    auto startedAt = std::chrono::steady_clock::now();
+    write<T>(handle, value);
+    DatarefProfiler::getInstance()->recordWrite(ref, byteSize(value), std::chrono::steady_clock::now() - startedAt);
+}
+
+template<typename T>
+void Dataref::write(XPLMDataRef handle, const T &value) {
     if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>) {
         XPLMDataTypeID refType = XPLMGetDataRefTypes(handle);
         if ((refType & xplmType_Float) == xplmType_Float) {
@@ -511,6 +566,8 @@ void Dataref::executeCommand(const char *command, XPLMCommandPhase phase) {
         return;
     }
 
+    LatencyTracker::markCommand();
+
     if (phase == -1) {
         XPLMCommandOnce(handle);
     } else if (phase == xplm_CommandBegin) {
@@ -558,11 +615,3 @@ int Dataref::_commandCallback(XPLMCommandRef inCommand, XPLMCommandPhase inPhase
 
     return 1;
 }
-
-std::unordered_map<std::string, uint64_t> &Dataref::getAccessStats() {
-    return debugAccessStats;
-}
-
-void Dataref::resetAccessStats() {
-    debugAccessStats.clear();
-}
@@ -42,6 +42,10 @@ class Dataref {
         std::unordered_map<std::string, XPLMDataRef> refs;
         std::unordered_map<std::string, CachedValue> cachedValues;
         XPLMDataRef findRef(const char *ref);
+        template<typename T>
+        T read(XPLMDataRef handle);
+        template<typename T>
+        void write(XPLMDataRef handle, const T &value);
 
     public:
         static Dataref *getInstance();
@@ -53,6 +57,8 @@ class Dataref {
         void bindExistingCommand(const char *command, CommandExecutedCallback callback);
         void createCommand(const char *command, const char *description, CommandExecutedCallback callback);
         void unbind(const char *ref);
+        // Only unbinds the ref while it still points at valuePointer, so a newer owner of the same name keeps it
+        void unbind(const char *ref, const void *valuePointer);
         void destroyAllBindings();
         int _commandCallback(XPLMCommandRef inCommand, XPLMCommandPhase inPhase, void *inRefcon);
 
@@ -70,10 +76,6 @@ class Dataref {
         void executeCommand(const char *command, XPLMCommandPhase phase = -1);
 
         void clearCache();
-
-        // Debug tracking
-        static std::unordered_map<std::string, uint64_t> &getAccessStats();
-        static void resetAccessStats();
 };
 
 #endif
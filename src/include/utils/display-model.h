@@ -0,0 +1,96 @@
+#ifndef DISPLAY_MODEL_H
+#define DISPLAY_MODEL_H
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+// One field of a display state and the display regions that show it
+template<typename T>
+struct DisplayField {
+        bool (*changed)(const T &current, const T &staged);
+        void (*apply)(T &current, const T &staged);
+        uint32_t regions;
+};
+
+template<typename T, auto Member>
+constexpr DisplayField<T> displayField(uint32_t regions) {
+    return {
+        [](const T &current, const T &staged) {
+            return current.*Member != staged.*Member;
+        },
+        [](T &current, const T &staged) {
+            current.*Member = staged.*Member;
+        },
+        regions,
+    };
+}
+
+// Display state with a dirty bit per field. Profiles write into edit(), commit() moves the
+// fields that changed into value() and reports which regions have to be encoded and sent again.
+template<typename T, size_t FieldCount>
+class DisplayModel {
+    public:
+        using Fields = std::array<DisplayField<T>, FieldCount>;
+
+        explicit DisplayModel(const Fields &fields) :
+            fields(fields) {}
+
+        T &edit() {
+            return staged;
+        }
+
+        const T &value() const {
+            return current;
+        }
+
+        uint32_t commit() {
+            for (size_t i = 0; i < FieldCount; i++) {
+                if (fields[i].changed(current, staged)) {
+                    fields[i].apply(current, staged);
+                    dirty.set(i);
+                }
+            }
+
+            return dirtyRegions();
+        }
+
+        uint32_t dirtyRegions() const {
+            uint32_t regions = 0;
+            for (size_t i = 0; i < FieldCount; i++) {
+                if (dirty.test(i)) {
+                    regions |= fields[i].regions;
+                }
+            }
+
+            return regions;
+        }
+
+        const std::bitset<FieldCount> &dirtyFields() const {
+            return dirty;
+        }
+
+        void markAllDirty() {
+            dirty.set();
+        }
+
+        void clearDirty() {
+            dirty.reset();
+        }
+
+        // Replace the whole state without marking it dirty, for when the display was written directly
+        void reset(const T &newValue) {
+            staged = newValue;
+            current = newValue;
+            dirty.reset();
+        }
+
+    private:
+        const Fields fields;
+        T staged = {};
+        T current = {};
+        std::bitset<FieldCount> dirty;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "frame-governor.h"
+
+#include "config.h"
+#include "dataref.h"
+
+#include <algorithm>
+
+static float toMilliseconds(FrameGovernor::Clock::duration duration) {
+    return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+FrameGovernor::~FrameGovernor() {
+    unbindDatarefs();
+}
+
+void FrameGovernor::beginFrame() {
+    frameSpent = Clock::duration::zero();
+}
+
+void FrameGovernor::record(FrameSubsystem subsystem, Clock::time_point since) {
+    auto elapsed = Clock::now() - since;
+    int index = static_cast<int>(subsystem);
+
+    frameSpent += elapsed;
+    totals[index] += elapsed;
+    maxima[index] = std::max(maxima[index], elapsed);
+}
+
+void FrameGovernor::endFrame() {
+    frames++;
+    frameTotal += frameSpent;
+    frameMax = std::max(frameMax, frameSpent);
+
+    if (overBudget()) {
+        overBudgetFrameCount++;
+    }
+}
+
+bool FrameGovernor::overBudget() const {
+    return toMilliseconds(frameSpent) >= budgetMs;
+}
+
+void FrameGovernor::markDeferred() {
+    deferred++;
+}
+
+float FrameGovernor::budget() const {
+    return budgetMs;
+}
+
+void FrameGovernor::setBudget(float milliseconds) {
+    budgetMs = std::max(milliseconds, 0.0f);
+}
+
+const FrameSummary &FrameGovernor::summary(FrameSubsystem subsystem) const {
+    return summaries[static_cast<int>(subsystem)];
+}
+
+const FrameSummary &FrameGovernor::frameSummary() const {
+    return frameTimes;
+}
+
+int FrameGovernor::overBudgetFrames() const {
+    return publishedOverBudgetFrames;
+}
+
+int FrameGovernor::deferredCount() const {
+    return publishedDeferred;
+}
+
+void FrameGovernor::publish() {
+    auto now = Clock::now();
+    if (now - lastPublish < std::chrono::milliseconds(PublishIntervalMs)) {
+        return;
+    }
+    lastPublish = now;
+
+    int divisor = std::max(frames, 1);
+    for (int i = 0; i < SubsystemCount; i++) {
+        summaries[i] = {
+            .avg = toMilliseconds(totals[i]) / divisor,
+            .max = toMilliseconds(maxima[i]),
+        };
+        totals[i] = Clock::duration::zero();
+        maxima[i] = Clock::duration::zero();
+    }
+
+    frameTimes = {
+        .avg = toMilliseconds(frameTotal) / divisor,
+        .max = toMilliseconds(frameMax),
+    };
+    publishedFrames = frames;
+    publishedOverBudgetFrames = overBudgetFrameCount;
+    publishedDeferred = deferred;
+
+    frameTotal = Clock::duration::zero();
+    frameMax = Clock::duration::zero();
+    frames = 0;
+    overBudgetFrameCount = 0;
+    deferred = 0;
+}
+
+void FrameGovernor::bindDatarefs() {
+    if (datarefsBound) {
+        return;
+    }
+    datarefsBound = true;
+
+    auto dataref = Dataref::getInstance();
+    dataref->createDataref<float>(PRODUCT_NAME "/frame/budget_ms", &budgetMs, true, [](float value) {
+        return value >= 0.0f;
+    });
+    dataref->createDataref<float>(PRODUCT_NAME "/frame/avg_ms", &frameTimes.avg);
+    dataref->createDataref<float>(PRODUCT_NAME "/frame/max_ms", &frameTimes.max);
+    dataref->createDataref<int>(PRODUCT_NAME "/frame/count", &publishedFrames);
+    dataref->createDataref<int>(PRODUCT_NAME "/frame/over_budget_count", &publishedOverBudgetFrames);
+    dataref->createDataref<int>(PRODUCT_NAME "/frame/deferred_count", &publishedDeferred);
+
+    for (int i = 0; i < SubsystemCount; i++) {
+        std::string prefix = std::string(PRODUCT_NAME "/frame/") + subsystemName(static_cast<FrameSubsystem>(i));
+        dataref->createDataref<float>((prefix + "/avg_ms").c_str(), &summaries[i].avg);
+        dataref->createDataref<float>((prefix + "/max_ms").c_str(), &summaries[i].max);
+    }
+}
+
+void FrameGovernor::unbindDatarefs() {
+    if (!datarefsBound) {
+        return;
+    }
+    datarefsBound = false;
+
+    auto dataref = Dataref::getInstance();
+    dataref->unbind(PRODUCT_NAME "/frame/budget_ms");
+    dataref->unbind(PRODUCT_NAME "/frame/avg_ms");
+    dataref->unbind(PRODUCT_NAME "/frame/max_ms");
+    dataref->unbind(PRODUCT_NAME "/frame/count");
+    dataref->unbind(PRODUCT_NAME "/frame/over_budget_count");
+    dataref->unbind(PRODUCT_NAME "/frame/deferred_count");
+
+    for (int i = 0; i < SubsystemCount; i++) {
+        std::string prefix = std::string(PRODUCT_NAME "/frame/") + subsystemName(static_cast<FrameSubsystem>(i));
+        dataref->unbind((prefix + "/avg_ms").c_str());
+        dataref->unbind((prefix + "/max_ms").c_str());
+    }
+}
+
+const char *FrameGovernor::subsystemName(FrameSubsystem subsystem) {
+    switch (subsystem) {
+        case FrameSubsystem::TASKS:
+            return "tasks";
+        case FrameSubsystem::DATAREFS:
+            return "datarefs";
+        case FrameSubsystem::INPUT:
+            return "input";
+        case FrameSubsystem::RENDER:
+            return "render";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <array>
+#include <chrono>
+#include <string>
+
+enum class FrameSubsystem : unsigned char {
+    TASKS = 0, // delayed tasks
+    DATAREFS,  // cached dataref polling
+    INPUT,     // device input dispatch
+    RENDER,    // device display and led output
+    _COUNT
+};
+
+struct FrameSummary {
+        float avg = 0.0f;
+        float max = 0.0f;
+};
+
+// Times each subsystem of a flight loop and tells deferrable work to wait a frame once the budget is spent
+class FrameGovernor {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr int SubsystemCount = static_cast<int>(FrameSubsystem::_COUNT);
+        static constexpr int PublishIntervalMs = 5000;
+        static constexpr float DefaultBudgetMs = 0.5f;
+
+        FrameGovernor() = default;
+        ~FrameGovernor();
+        FrameGovernor(const FrameGovernor &) = delete;
+        FrameGovernor &operator=(const FrameGovernor &) = delete;
+
+        void beginFrame();
+        void record(FrameSubsystem subsystem, Clock::time_point since);
+        void endFrame();
+
+        bool overBudget() const;
+        void markDeferred();
+
+        float budget() const;
+        void setBudget(float milliseconds);
+
+        const FrameSummary &summary(FrameSubsystem subsystem) const;
+        const FrameSummary &frameSummary() const;
+        int overBudgetFrames() const;
+        int deferredCount() const;
+        void publish();
+
+        void bindDatarefs();
+        void unbindDatarefs();
+        static const char *subsystemName(FrameSubsystem subsystem);
+
+    private:
+        float budgetMs = DefaultBudgetMs;
+        Clock::duration frameSpent = Clock::duration::zero();
+        Clock::time_point lastPublish;
+        bool datarefsBound = false;
+
+        // Accumulated since the last publish
+        std::array<Clock::duration, SubsystemCount> totals{};
+        std::array<Clock::duration, SubsystemCount> maxima{};
+        Clock::duration frameTotal = Clock::duration::zero();
+        Clock::duration frameMax = Clock::duration::zero();
+        int frames = 0;
+        int overBudgetFrameCount = 0;
+        int deferred = 0;
+
+        // Published every PublishIntervalMs
+        std::array<FrameSummary, SubsystemCount> summaries;
+        FrameSummary frameTimes;
+        int publishedFrames = 0;
+        int publishedOverBudgetFrames = 0;
+        int publishedDeferred = 0;
+};
+
+#endif
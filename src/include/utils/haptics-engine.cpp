@@ -0,0 +1,201 @@
+#include "haptics-engine.h"
+
+#include "dataref.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+
+// Runway rumble while rolling, scaled with ground speed
+static constexpr float RumbleMinSpeed = 1.0f;
+static constexpr float RumbleFullSpeed = 30.0f;
+static constexpr float RumbleBaseLevel = 0.004f;
+static constexpr float RumbleSpeedLevel = 0.012f;
+static constexpr float RumbleBaseFrequency = 6.0f;
+
+// Touchdown impulse, scaled with the sink rate and decaying over a few ticks
+static constexpr float TouchdownSinkRateScale = 600.0f;
+static constexpr float TouchdownLevel = 0.15f;
+static constexpr float TouchdownMinLevel = 0.05f;
+static constexpr float TouchdownMaxLevel = 0.3f;
+static constexpr float TouchdownDecaySeconds = 0.15f;
+
+HapticsEngine *HapticsEngine::instance = nullptr;
+
+HapticsEngine::HapticsEngine() {
+    outputs = {};
+}
+
+HapticsEngine::~HapticsEngine() {
+    shutdown();
+    instance = nullptr;
+}
+
+HapticsEngine *HapticsEngine::getInstance() {
+    if (instance == nullptr) {
+        instance = new HapticsEngine();
+    }
+
+    return instance;
+}
+
+void HapticsEngine::addOutput(const void *owner, HapticsOutput output) {
+    std::lock_guard<std::mutex> lock(outputsMutex);
+    std::erase_if(outputs, [owner](const HapticsOutputEntry &entry) {
+        return entry.owner == owner;
+    });
+    outputs.push_back({.owner = owner, .output = std::move(output)});
+    sampling = true;
+
+    if (!running) {
+        running = true;
+        thread = std::thread(&HapticsEngine::threadLoop, this);
+    }
+}
+
+void HapticsEngine::removeOutput(const void *owner) {
+    {
+        std::lock_guard<std::mutex> lock(outputsMutex);
+        std::erase_if(outputs, [owner](const HapticsOutputEntry &entry) {
+            return entry.owner == owner;
+        });
+
+        if (!outputs.empty()) {
+            return;
+        }
+    }
+
+    stop();
+}
+
+void HapticsEngine::sample() {
+    if (!sampling) {
+        return;
+    }
+
+    auto datarefManager = Dataref::getInstance();
+    HapticsSample next = {
+        .gForce = datarefManager->getCached<float>("sim/flightmodel/forces/g_nrml"),
+        .groundSpeed = datarefManager->getCached<float>("sim/flightmodel/position/groundspeed"),
+        .verticalSpeed = datarefManager->getCached<float>("sim/flightmodel/position/vh_ind_fpm"),
+        .onGround = datarefManager->getCached<bool>("sim/flightmodel/failures/onground_any"),
+        .active = datarefManager->getCached<bool>("sim/cockpit/electrical/avionics_on") && !datarefManager->getCached<bool>("sim/time/paused"),
+    };
+
+    std::lock_guard<std::mutex> lock(samplesMutex);
+    samples[samplesWritten % SampleBufferSize] = next;
+    samplesWritten++;
+}
+
+void HapticsEngine::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(outputsMutex);
+        outputs.clear();
+    }
+
+    stop();
+}
+
+void HapticsEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(outputsMutex);
+        if (!running) {
+            return;
+        }
+
+        running = false;
+        sampling = false;
+    }
+
+    stopCV.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void HapticsEngine::threadLoop() {
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.0f / TickRateHz));
+    auto nextTick = std::chrono::steady_clock::now();
+    float seconds = 1.0f / TickRateHz;
+
+    {
+        std::lock_guard<std::mutex> lock(samplesMutex);
+        samplesRead = samplesWritten;
+    }
+    lastSample = {};
+    impulse = 0.0f;
+    rumblePhase = 0.0f;
+
+    std::unique_lock<std::mutex> lock(outputsMutex);
+    while (running) {
+        float level = tick(seconds);
+        for (auto &entry : outputs) {
+            entry.output(level);
+        }
+
+        nextTick += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (nextTick < now) {
+            // Fell behind, e.g. after a stall, do not try to catch up with a burst of ticks
+            nextTick = now + interval;
+        }
+
+        stopCV.wait_until(lock, nextTick, [this]() {
+            return !running;
+        });
+    }
+}
+
+float HapticsEngine::tick(float seconds) {
+    std::array<HapticsSample, SampleBufferSize> pending;
+    size_t pendingCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(samplesMutex);
+        if (samplesWritten - samplesRead > SampleBufferSize) {
+            samplesRead = samplesWritten - SampleBufferSize;
+        }
+
+        for (; samplesRead < samplesWritten; samplesRead++) {
+            pending[pendingCount++] = samples[samplesRead % SampleBufferSize];
+        }
+    }
+
+    // Total g variation since the last tick, which does not depend on how many frames it was spread over
+    float variation = 0.0f;
+    for (size_t i = 0; i < pendingCount; i++) {
+        const HapticsSample &next = pending[i];
+        if (next.active && lastSample.active) {
+            variation += std::fabs(next.gForce - lastSample.gForce);
+
+            if (next.onGround && !lastSample.onGround) {
+                float touchdown = std::clamp(-next.verticalSpeed / TouchdownSinkRateScale * TouchdownLevel, TouchdownMinLevel, TouchdownMaxLevel);
+                impulse = std::max(impulse, touchdown);
+            }
+        }
+
+        lastSample = next;
+    }
+
+    if (!lastSample.active) {
+        impulse = 0.0f;
+        return 0.0f;
+    }
+
+    float level = variation * (lastSample.onGround ? 1.0f : 0.5f);
+
+    if (lastSample.onGround && lastSample.groundSpeed > RumbleMinSpeed) {
+        float speedRatio = std::min(lastSample.groundSpeed / RumbleFullSpeed, 1.0f);
+        rumblePhase = std::fmod(rumblePhase + seconds * RumbleBaseFrequency * (1.0f + speedRatio), 1.0f);
+        float amplitude = RumbleBaseLevel + RumbleSpeedLevel * speedRatio;
+        level += amplitude * (0.6f + 0.4f * std::sin(2.0f * std::numbers::pi_v<float> * rumblePhase));
+    }
+
+    level += impulse;
+    impulse *= std::exp(-seconds / TouchdownDecaySeconds);
+    if (impulse < 0.001f) {
+        impulse = 0.0f;
+    }
+
+    return level;
+}
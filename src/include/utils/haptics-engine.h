@@ -0,0 +1,71 @@
+#ifndef HAPTICS_ENGINE_H
+#define HAPTICS_ENGINE_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HapticsSample {
+        float gForce = 1.0f;
+        float groundSpeed = 0.0f;   // m/s
+        float verticalSpeed = 0.0f; // ft/min
+        bool onGround = false;
+        bool active = false; // powered and not paused
+};
+
+// Receives the vibration level on the haptics thread, in g of load change per tick like the old per-frame g delta
+using HapticsOutput = std::function<void(float level)>;
+
+struct HapticsOutputEntry {
+        const void *owner;
+        HapticsOutput output;
+};
+
+// Samples the sim once per frame and synthesizes vibration on its own fixed rate thread, so the feel does not depend on the frame rate
+class HapticsEngine {
+    private:
+        HapticsEngine();
+        ~HapticsEngine();
+        static HapticsEngine *instance;
+
+        static constexpr int TickRateHz = 60;
+        static constexpr size_t SampleBufferSize = 64;
+
+        // Written by the flight loop, read by the haptics thread. The reader may lag a full ring behind,
+        // so both sides copy samples under the mutex instead of racing on a slot being overwritten.
+        std::array<HapticsSample, SampleBufferSize> samples;
+        uint64_t samplesWritten = 0;
+        std::mutex samplesMutex;
+        std::atomic<bool> sampling{false};
+
+        std::vector<HapticsOutputEntry> outputs;
+        std::mutex outputsMutex;
+        std::condition_variable stopCV;
+        std::thread thread;
+        bool running = false;
+
+        // Only touched by the haptics thread
+        uint64_t samplesRead = 0;
+        HapticsSample lastSample;
+        float impulse = 0.0f;
+        float rumblePhase = 0.0f;
+
+        void threadLoop();
+        float tick(float seconds);
+        void stop();
+
+    public:
+        static HapticsEngine *getInstance();
+
+        void addOutput(const void *owner, HapticsOutput output);
+        void removeOutput(const void *owner);
+        void sample();
+        void shutdown();
+};
+
+#endif
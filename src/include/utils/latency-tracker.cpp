@@ -0,0 +1,237 @@
+#include "latency-tracker.h"
+
+#include "config.h"
+#include "dataref.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+struct ActiveInput {
+        LatencyTracker *tracker = nullptr;
+        LatencyTracker::Clock::time_point readAt;
+        bool dispatched = false;
+        bool commanded = false;
+};
+
+static ActiveInput activeInput;
+static LatencyTracker::Clock::time_point datarefChangedAt;
+static bool dispatchingDatarefChange = false;
+
+int LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < SubBucketCount) {
+        return static_cast<int>(micros);
+    }
+
+    int shift = static_cast<int>(std::bit_width(micros)) - 1 - SubBucketBits;
+    int subBucket = static_cast<int>(micros >> shift) - SubBucketCount;
+    int index = (shift + 1) * SubBucketCount + subBucket;
+    return std::min(index, BucketCount - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SubBucketCount) {
+        return index;
+    }
+
+    int shift = index / SubBucketCount - 1;
+    uint64_t subBucket = index % SubBucketCount;
+    return ((SubBucketCount + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t previous = maxValue.load(std::memory_order_relaxed);
+    while (micros > previous && !maxValue.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::max() const {
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    uint64_t samples = count();
+    if (samples == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(samples * percent / 100.0)));
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+
+    return max();
+}
+
+LatencyTracker::~LatencyTracker() {
+    if (activeInput.tracker == this) {
+        endInput();
+    }
+
+    unbindDatarefs();
+}
+
+void LatencyTracker::record(LatencyStage stage, Clock::time_point since, Clock::time_point until) {
+    if (since == Clock::time_point{} || until < since) {
+        return;
+    }
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(until - since).count();
+    histograms[static_cast<int>(stage)].record(static_cast<uint64_t>(micros));
+}
+
+const LatencySummary &LatencyTracker::summary(LatencyStage stage) const {
+    return summaries[static_cast<int>(stage)];
+}
+
+void LatencyTracker::publish(const std::string &deviceKey) {
+    if (boundPrefix.empty()) {
+        bindDatarefs(deviceKey);
+    }
+
+    auto now = Clock::now();
+    if (now - lastPublish < std::chrono::milliseconds(PublishIntervalMs)) {
+        return;
+    }
+    lastPublish = now;
+
+    for (int i = 0; i < StageCount; i++) {
+        auto &histogram = histograms[i];
+        summaries[i] = {
+            .count = static_cast<int>(histogram.count()),
+            .p50 = histogram.percentile(50.0) / 1000.0f,
+            .p99 = histogram.percentile(99.0) / 1000.0f,
+            .max = histogram.max() / 1000.0f,
+        };
+        histogram.reset();
+    }
+}
+
+void LatencyTracker::markRender() {
+    if (datarefChangedAt <= lastRenderedChange) {
+        outputChangedAt = {};
+        return;
+    }
+
+    record(LatencyStage::OUTPUT_RENDER, datarefChangedAt);
+    lastRenderedChange = datarefChangedAt;
+    outputChangedAt = datarefChangedAt;
+}
+
+void LatencyTracker::endOutput() {
+    outputChangedAt = {};
+}
+
+LatencyTracker::Clock::time_point LatencyTracker::outputOrigin() const {
+    if (outputChangedAt != Clock::time_point{}) {
+        return outputChangedAt;
+    }
+
+    // LED writes happen straight from the dataref change callbacks
+    return dispatchingDatarefChange ? datarefChangedAt : Clock::time_point{};
+}
+
+void LatencyTracker::beginInput(Clock::time_point readAt) {
+    activeInput = {
+        .tracker = this,
+        .readAt = readAt,
+    };
+}
+
+void LatencyTracker::endInput() {
+    activeInput = {};
+}
+
+void LatencyTracker::markDispatch() {
+    if (!activeInput.tracker || activeInput.dispatched) {
+        return;
+    }
+
+    activeInput.dispatched = true;
+    activeInput.tracker->record(LatencyStage::INPUT_DISPATCH, activeInput.readAt);
+}
+
+void LatencyTracker::markCommand() {
+    if (!activeInput.tracker || activeInput.commanded) {
+        return;
+    }
+
+    activeInput.commanded = true;
+    activeInput.tracker->record(LatencyStage::INPUT_COMMAND, activeInput.readAt);
+}
+
+void LatencyTracker::markDatarefChange() {
+    datarefChangedAt = Clock::now();
+}
+
+void LatencyTracker::setDispatchingDatarefChange(bool dispatching) {
+    dispatchingDatarefChange = dispatching;
+}
+
+const char *LatencyTracker::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::INPUT_ENQUEUE:
+            return "input_enqueue";
+        case LatencyStage::INPUT_DEQUEUE:
+            return "input_dequeue";
+        case LatencyStage::INPUT_DISPATCH:
+            return "input_dispatch";
+        case LatencyStage::INPUT_COMMAND:
+            return "input_command";
+        case LatencyStage::OUTPUT_RENDER:
+            return "output_render";
+        case LatencyStage::OUTPUT_ENQUEUE:
+            return "output_enqueue";
+        case LatencyStage::OUTPUT_WRITE:
+            return "output_write";
+        default:
+            return "unknown";
+    }
+}
+
+void LatencyTracker::bindDatarefs(const std::string &deviceKey) {
+    boundPrefix = std::string(PRODUCT_NAME "/latency/") + deviceKey + "/";
+
+    for (int i = 0; i < StageCount; i++) {
+        std::string stagePrefix = boundPrefix + stageName(static_cast<LatencyStage>(i));
+        Dataref::getInstance()->createDataref<int>((stagePrefix + "/count").c_str(), &summaries[i].count);
+        Dataref::getInstance()->createDataref<float>((stagePrefix + "/p50_ms").c_str(), &summaries[i].p50);
+        Dataref::getInstance()->createDataref<float>((stagePrefix + "/p99_ms").c_str(), &summaries[i].p99);
+        Dataref::getInstance()->createDataref<float>((stagePrefix + "/max_ms").c_str(), &summaries[i].max);
+    }
+}
+
+void LatencyTracker::unbindDatarefs() {
+    if (boundPrefix.empty()) {
+        return;
+    }
+
+    for (int i = 0; i < StageCount; i++) {
+        std::string stagePrefix = boundPrefix + stageName(static_cast<LatencyStage>(i));
+        Dataref::getInstance()->unbind((stagePrefix + "/count").c_str(), &summaries[i].count);
+        Dataref::getInstance()->unbind((stagePrefix + "/p50_ms").c_str(), &summaries[i].p50);
+        Dataref::getInstance()->unbind((stagePrefix + "/p99_ms").c_str(), &summaries[i].p99);
+        Dataref::getInstance()->unbind((stagePrefix + "/max_ms").c_str(), &summaries[i].max);
+    }
+
+    boundPrefix.clear();
+}
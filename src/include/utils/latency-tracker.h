@@ -0,0 +1,94 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum class LatencyStage : unsigned char {
+    INPUT_ENQUEUE = 0, // hid read -> queued for main thread
+    INPUT_DEQUEUE,     // hid read -> dequeued on main thread
+    INPUT_DISPATCH,    // hid read -> button dispatched to profile
+    INPUT_COMMAND,     // hid read -> command / dataref write
+    OUTPUT_RENDER,     // dataref change -> display rendered
+    OUTPUT_ENQUEUE,    // dataref change -> packet queued
+    OUTPUT_WRITE,      // dataref change -> packet written to device
+    _COUNT
+};
+
+// Log-linear histogram in microseconds (HDR style, 3 significant bits per power of two).
+// Recording is lock-free so the input and write threads can record alongside the main thread.
+class LatencyHistogram {
+    public:
+        static constexpr int SubBucketBits = 3;
+        static constexpr int SubBucketCount = 1 << SubBucketBits;
+        static constexpr int MagnitudeCount = 25;
+        static constexpr int BucketCount = MagnitudeCount * SubBucketCount;
+
+        void record(uint64_t micros);
+        void reset();
+        uint64_t count() const;
+        uint64_t max() const;
+        uint64_t percentile(double percent) const;
+
+    private:
+        std::array<std::atomic<uint32_t>, BucketCount> buckets{};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> maxValue{0};
+
+        static int bucketIndex(uint64_t micros);
+        static uint64_t bucketUpperBound(int index);
+};
+
+struct LatencySummary {
+        int count = 0;
+        float p50 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+};
+
+class LatencyTracker {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr int StageCount = static_cast<int>(LatencyStage::_COUNT);
+        static constexpr int PublishIntervalMs = 5000;
+
+        LatencyTracker() = default;
+        ~LatencyTracker();
+        LatencyTracker(const LatencyTracker &) = delete;
+        LatencyTracker &operator=(const LatencyTracker &) = delete;
+
+        void record(LatencyStage stage, Clock::time_point since, Clock::time_point until = Clock::now());
+        const LatencySummary &summary(LatencyStage stage) const;
+        void publish(const std::string &deviceKey);
+
+        // Output path: a render consumes the most recent dataref change, packets written while it is active are traced
+        void markRender();
+        void endOutput();
+        Clock::time_point outputOrigin() const;
+
+        // Input path: main thread only, active while one input event is being handled
+        void beginInput(Clock::time_point readAt);
+        static void endInput();
+        static void markDispatch();
+        static void markCommand();
+
+        static void markDatarefChange();
+        static void setDispatchingDatarefChange(bool dispatching);
+        static const char *stageName(LatencyStage stage);
+
+    private:
+        std::array<LatencyHistogram, StageCount> histograms;
+        std::array<LatencySummary, StageCount> summaries;
+        std::string boundPrefix;
+        Clock::time_point lastPublish;
+        Clock::time_point lastRenderedChange;
+        Clock::time_point outputChangedAt;
+
+        void bindDatarefs(const std::string &deviceKey);
+        void unbindDatarefs();
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "logger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <XPLMUtilities.h>
+
+Logger *Logger::instance = nullptr;
+
+Logger::Logger() {
+    for (size_t i = 0; i < Capacity; i++) {
+        messages[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() {
+    shutdown();
+    instance = nullptr;
+}
+
+Logger *Logger::getInstance() {
+    if (instance == nullptr) {
+        instance = new Logger();
+    }
+
+    return instance;
+}
+
+void Logger::log(const char *format, ...) {
+    if (!allow(format)) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    push(format, args);
+    va_end(args);
+
+    if (!running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        if (!running && !stopped) {
+            running = true;
+            thread = std::thread(&Logger::threadLoop, this);
+        }
+    }
+
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_one();
+}
+
+void Logger::flush() {
+    drain();
+}
+
+void Logger::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        stopped = true;
+        running = false;
+    }
+
+    wakeups.fetch_add(1, std::memory_order_release);
+    wakeups.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    drain();
+}
+
+bool Logger::allow(const char *site) {
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Call sites that hash to the same slot share a limit, which only makes the limit stricter
+    RateLimit &limit = rateLimits[(reinterpret_cast<uintptr_t>(site) >> 3) % RateLimitSlots];
+    int64_t windowStart = limit.windowStartMs.load(std::memory_order_relaxed);
+    if (nowMs - windowStart >= 1000 && limit.windowStartMs.compare_exchange_strong(windowStart, nowMs, std::memory_order_relaxed)) {
+        limit.count.store(0, std::memory_order_relaxed);
+
+        uint32_t suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+        if (suppressed > 0) {
+            pushText("[WINCTRL] %u repeated log messages were suppressed\n", suppressed);
+        }
+    }
+
+    if (limit.count.fetch_add(1, std::memory_order_relaxed) < RateLimitPerSecond) {
+        return true;
+    }
+
+    limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Logger::push(const char *format, va_list args) {
+    if (stopped.load(std::memory_order_acquire)) {
+        char text[MessageSize];
+        vsnprintf(text, sizeof(text), format, args);
+        write(text);
+        return;
+    }
+
+    uint64_t position = head.load(std::memory_order_relaxed);
+    Message *message = nullptr;
+    while (true) {
+        message = &messages[position % Capacity];
+        uint64_t sequence = message->sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence - position);
+
+        if (difference == 0) {
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Full, the writer thread has not caught up
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    vsnprintf(message->text, MessageSize, format, args);
+    message->sequence.store(position + 1, std::memory_order_release);
+}
+
+void Logger::pushText(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    push(format, args);
+    va_end(args);
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    char text[MessageSize];
+
+    while (true) {
+        Message &message = messages[tail % Capacity];
+        if (message.sequence.load(std::memory_order_acquire) != tail + 1) {
+            break;
+        }
+
+        std::memcpy(text, message.text, MessageSize);
+        message.sequence.store(tail + Capacity, std::memory_order_release);
+        tail++;
+
+        write(text);
+    }
+
+    uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        snprintf(text, sizeof(text), "[WINCTRL] %u log messages were dropped, the log buffer was full\n", lost);
+        write(text);
+    }
+}
+
+void Logger::threadLoop() {
+    while (true) {
+        uint32_t seen = wakeups.load(std::memory_order_acquire);
+        drain();
+
+        if (!running.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        wakeups.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void Logger::write(const char *text) {
+    XPLMDebugString(text);
+#if DEBUG
+    printf("%s", text);
+#endif
+}
@@ -0,0 +1,73 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Lets the compiler check log arguments against the format, as it did when debug() expanded to snprintf
+#if defined(__GNUC__) || defined(__clang__)
+#define LOGGER_PRINTF_FORMAT(formatIndex, firstArgument) __attribute__((format(printf, formatIndex, firstArgument)))
+#else
+#define LOGGER_PRINTF_FORMAT(formatIndex, firstArgument)
+#endif
+
+// Log lines are formatted into a bounded lock-free ring by the calling thread and written to Log.txt by a background thread.
+// A call site that logs more than RateLimitPerSecond lines per second has the rest dropped and counted.
+class Logger {
+    private:
+        Logger();
+        ~Logger();
+        static Logger *instance;
+
+        static constexpr size_t Capacity = 128;
+        static constexpr size_t MessageSize = 1024;
+        static constexpr size_t RateLimitSlots = 64;
+        static constexpr uint32_t RateLimitPerSecond = 50;
+
+        struct Message {
+                std::atomic<uint64_t> sequence;
+                char text[MessageSize];
+        };
+
+        struct RateLimit {
+                std::atomic<int64_t> windowStartMs{0};
+                std::atomic<uint32_t> count{0};
+                std::atomic<uint32_t> suppressed{0};
+        };
+
+        std::array<Message, Capacity> messages;
+        std::atomic<uint64_t> head{0};
+        uint64_t tail = 0;
+        std::mutex drainMutex;
+
+        std::array<RateLimit, RateLimitSlots> rateLimits;
+        std::atomic<uint32_t> dropped{0};
+
+        std::atomic<uint32_t> wakeups{0};
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopped{false};
+        std::thread thread;
+        std::mutex threadMutex;
+
+        bool allow(const char *site);
+        void push(const char *format, va_list args);
+        void pushText(const char *format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+        void drain();
+        void threadLoop();
+        static void write(const char *text);
+
+    public:
+        static Logger *getInstance();
+
+        // The format string identifies the call site for rate limiting, so it should be a literal
+        void log(const char *format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+
+        void flush();
+        void shutdown();
+};
+
+#endif
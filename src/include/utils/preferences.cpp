@@ -0,0 +1,188 @@
+#include "preferences.h"
+
+#include "appstate.h"
+#include "config.h"
+#include "SimpleIni.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <XPLMUtilities.h>
+
+static constexpr const char *SectionName = "Preferences";
+
+Preferences *Preferences::instance = nullptr;
+
+Preferences::Preferences() {
+    values = {};
+    observers = {};
+}
+
+Preferences::~Preferences() {
+    shutdown();
+    instance = nullptr;
+}
+
+Preferences *Preferences::getInstance() {
+    if (instance == nullptr) {
+        instance = new Preferences();
+    }
+
+    return instance;
+}
+
+void Preferences::load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    path = AppState::getInstance()->getPluginDirectory() + "/preferences.ini";
+
+    CSimpleIniA ini;
+    ini.SetUnicode();
+    if (ini.LoadFile(path.c_str()) < 0) {
+        return;
+    }
+
+    CSimpleIniA::TNamesDepend keys;
+    ini.GetAllKeys(SectionName, keys);
+    for (const auto &key : keys) {
+        values[key.pItem] = ini.GetValue(SectionName, key.pItem, "");
+    }
+}
+
+std::string Preferences::get(const std::string &key, const std::string &defaultValue) {
+    std::lock_guard<std::mutex> lock(valuesMutex);
+    load();
+
+    auto it = values.find(key);
+    if (it == values.end()) {
+        return defaultValue;
+    }
+
+    return it->second;
+}
+
+float Preferences::getFloat(const std::string &key, float defaultValue) {
+    std::string value = get(key, "");
+    char *parsedEnd = nullptr;
+    float parsed = std::strtof(value.c_str(), &parsedEnd);
+    return parsedEnd != value.c_str() ? parsed : defaultValue;
+}
+
+void Preferences::set(const std::string &key, const std::string &value) {
+    {
+        std::lock_guard<std::mutex> lock(valuesMutex);
+        load();
+
+        auto it = values.find(key);
+        if (it != values.end() && it->second == value) {
+            return;
+        }
+
+        values[key] = value;
+        dirty = true;
+
+        if (!writeThreadRunning) {
+            writeThreadRunning = true;
+            writeThread = std::thread(&Preferences::writeThreadLoop, this);
+        }
+    }
+    writeCV.notify_one();
+
+    // Observers may change preferences themselves, so they are called on a copy
+    std::vector<PreferenceChangedCallback> callbacks;
+    for (const auto &observer : observers) {
+        if (observer.key == key) {
+            callbacks.push_back(observer.callback);
+        }
+    }
+
+    for (const auto &callback : callbacks) {
+        callback(value);
+    }
+}
+
+void Preferences::observe(const void *owner, const std::string &key, PreferenceChangedCallback callback) {
+    std::erase_if(observers, [owner, &key](const PreferenceObserver &observer) {
+        return observer.owner == owner && observer.key == key;
+    });
+    observers.push_back({.owner = owner, .key = key, .callback = std::move(callback)});
+}
+
+void Preferences::removeObservers(const void *owner) {
+    std::erase_if(observers, [owner](const PreferenceObserver &observer) {
+        return observer.owner == owner;
+    });
+}
+
+void Preferences::flush() {
+    // The snapshot is taken while holding the file, so an older snapshot can never overwrite a newer one
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+
+    std::unordered_map<std::string, std::string> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(valuesMutex);
+        if (!dirty) {
+            return;
+        }
+
+        snapshot = values;
+        dirty = false;
+    }
+
+    save(snapshot);
+}
+
+void Preferences::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(valuesMutex);
+        writeThreadRunning = false;
+    }
+
+    writeCV.notify_all();
+    if (writeThread.joinable()) {
+        writeThread.join();
+    }
+
+    flush();
+}
+
+void Preferences::save(const std::unordered_map<std::string, std::string> &snapshot) {
+    // Other sections and comments in the file are kept
+    CSimpleIniA ini;
+    ini.SetUnicode();
+    ini.LoadFile(path.c_str());
+
+    for (const auto &[key, value] : snapshot) {
+        ini.SetValue(SectionName, key.c_str(), value.c_str());
+    }
+
+    if (ini.SaveFile(path.c_str()) < 0) {
+        debug_force("Failed to save preferences file.\n");
+    }
+}
+
+void Preferences::writeThreadLoop() {
+    std::unique_lock<std::mutex> lock(valuesMutex);
+
+    while (writeThreadRunning) {
+        writeCV.wait(lock, [this]() {
+            return dirty || !writeThreadRunning;
+        });
+
+        // Changes that follow shortly after are written together
+        writeCV.wait_for(lock, std::chrono::milliseconds(WriteDelayMs), [this]() {
+            return !writeThreadRunning;
+        });
+
+        if (!writeThreadRunning) {
+            break;
+        }
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using PreferenceChangedCallback = std::function<void(const std::string &value)>;
+
+struct PreferenceObserver {
+        const void *owner;
+        std::string key;
+        PreferenceChangedCallback callback;
+};
+
+// preferences.ini is read once into memory. Changes are written back on a background thread, coalesced over WriteDelayMs.
+class Preferences {
+    private:
+        Preferences();
+        ~Preferences();
+        static Preferences *instance;
+
+        static constexpr int WriteDelayMs = 1000;
+
+        std::string path;
+        bool loaded = false;
+        std::unordered_map<std::string, std::string> values;
+        std::vector<PreferenceObserver> observers;
+
+        std::mutex valuesMutex;
+        std::mutex fileMutex;
+        std::condition_variable writeCV;
+        std::thread writeThread;
+        bool writeThreadRunning = false;
+        bool dirty = false;
+
+        void load();
+        void writeThreadLoop();
+        void save(const std::unordered_map<std::string, std::string> &snapshot);
+
+    public:
+        static Preferences *getInstance();
+
+        std::string get(const std::string &key, const std::string &defaultValue);
+        float getFloat(const std::string &key, float defaultValue);
+        void set(const std::string &key, const std::string &value);
+
+        // Callbacks run on the main thread, right after set() changed the value
+        void observe(const void *owner, const std::string &key, PreferenceChangedCallback callback);
+        void removeObservers(const void *owner);
+
+        void flush();
+        void shutdown();
+};
+
+#endif
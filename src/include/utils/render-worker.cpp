@@ -0,0 +1,108 @@
+#include "render-worker.h"
+
+#include <algorithm>
+
+RenderWorker *RenderWorker::instance = nullptr;
+
+RenderWorker::RenderWorker() {
+    jobs = {};
+    busyOwners = {};
+}
+
+RenderWorker::~RenderWorker() {
+    shutdown();
+    instance = nullptr;
+}
+
+RenderWorker *RenderWorker::getInstance() {
+    if (instance == nullptr) {
+        instance = new RenderWorker();
+    }
+
+    return instance;
+}
+
+void RenderWorker::submit(const void *owner, std::function<void()> func) {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        if (!running) {
+            running = true;
+            unsigned int count = std::clamp(std::thread::hardware_concurrency() / 4, 1u, MaxWorkerCount);
+            for (unsigned int i = 0; i < count; ++i) {
+                workers.emplace_back(&RenderWorker::workerLoop, this);
+            }
+        }
+
+        jobs.push_back({.owner = owner, .func = std::move(func)});
+    }
+
+    jobsCV.notify_one();
+}
+
+bool RenderWorker::hasPendingJobs(const void *owner) {
+    if (busyOwners.contains(owner)) {
+        return true;
+    }
+
+    return std::any_of(jobs.begin(), jobs.end(), [owner](const RenderJob &job) {
+        return job.owner == owner;
+    });
+}
+
+void RenderWorker::waitForJobs(const void *owner) {
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    idleCV.wait(lock, [this, owner]() {
+        return !hasPendingJobs(owner);
+    });
+}
+
+void RenderWorker::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        if (!running) {
+            return;
+        }
+
+        running = false;
+        jobs.clear();
+    }
+
+    jobsCV.notify_all();
+    idleCV.notify_all();
+    for (auto &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void RenderWorker::workerLoop() {
+    std::unique_lock<std::mutex> lock(jobsMutex);
+
+    while (true) {
+        auto next = jobs.end();
+        jobsCV.wait(lock, [this, &next]() {
+            next = std::find_if(jobs.begin(), jobs.end(), [this](const RenderJob &job) {
+                return !busyOwners.contains(job.owner);
+            });
+            return !running || next != jobs.end();
+        });
+
+        if (!running) {
+            return;
+        }
+
+        RenderJob job = std::move(*next);
+        jobs.erase(next);
+        busyOwners.insert(job.owner);
+
+        lock.unlock();
+        job.func();
+        lock.lock();
+
+        busyOwners.erase(job.owner);
+        jobsCV.notify_all();
+        idleCV.notify_all();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef RENDER_WORKER_H
+#define RENDER_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct RenderJob {
+        const void *owner;
+        std::function<void()> func;
+};
+
+// Encodes display snapshots taken on the main thread. Jobs of the same owner run in submission order, never concurrently.
+class RenderWorker {
+    private:
+        RenderWorker();
+        ~RenderWorker();
+        static RenderWorker *instance;
+
+        static constexpr unsigned int MaxWorkerCount = 2;
+        std::vector<std::thread> workers;
+        std::deque<RenderJob> jobs;
+        std::set<const void *> busyOwners;
+        std::mutex jobsMutex;
+        std::condition_variable jobsCV;
+        std::condition_variable idleCV;
+        bool running = false;
+
+        void workerLoop();
+        bool hasPendingJobs(const void *owner);
+
+    public:
+        static RenderWorker *getInstance();
+
+        void submit(const void *owner, std::function<void()> func);
+        void waitForJobs(const void *owner);
+        void shutdown();
+};
+
+#endif
@@ -1,13 +1,13 @@
 #include "segment-display.h"
 
 #include <algorithm>
-#include <map>
+#include <cmath>
+#include <cstdlib>
 
 namespace SegmentDisplay {
 
-    uint8_t getSegmentRepresentation(char c) {
-        char upperC = std::toupper(c);
-        switch (upperC) {
+    constexpr uint8_t segmentRepresentationFor(char c) {
+        switch (c) {
             case '0':
                 return 0xFA;
             case '1':
@@ -97,9 +97,8 @@ namespace SegmentDisplay {
         }
     }
 
-    uint8_t getSegmentMask(char c) {
-        char upperC = std::toupper(c);
-        switch (upperC) {
+    constexpr uint8_t segmentMaskFor(char c) {
+        switch (c) {
                 // Numbers
             case '0':
                 return 0x3F; // 011 1111
@@ -188,217 +187,129 @@ namespace SegmentDisplay {
         }
     }
 
-    uint8_t swapNibbles(uint8_t value) {
-        return ((value & 0x0F) << 4) | ((value & 0xF0) >> 4);
-    }
-
-    std::string fixStringLength(const std::string &value, int length, char fillChar) {
-        std::string result = value;
-        if (result.length() > static_cast<size_t>(length)) {
-            result = result.substr(result.length() - length);
-        }
-        while (result.length() < static_cast<size_t>(length)) {
-            result = fillChar + result;
-        }
+    // EFIS displays wire the segments in a different order
+    constexpr uint8_t efisRepresentationFor(char c) {
+        uint8_t segments = segmentRepresentationFor(c);
+        uint8_t result = 0;
+        result |= (segments & 0x08) ? 0x01 : 0; // Upper left -> bit 0
+        result |= (segments & 0x04) ? 0x02 : 0; // Middle -> bit 1
+        result |= (segments & 0x02) ? 0x04 : 0; // Lower left -> bit 2
+        result |= (segments & 0x10) ? 0x08 : 0; // Bottom -> bit 3
+        result |= (segments & 0x80) ? 0x10 : 0; // Top -> bit 4
+        result |= (segments & 0x40) ? 0x20 : 0; // Upper right -> bit 5
+        result |= (segments & 0x20) ? 0x40 : 0; // Lower right -> bit 6
+        result |= (segments & 0x01) ? 0x80 : 0; // Dot -> bit 7
         return result;
     }
 
-    std::vector<uint8_t> encodeString(int numSegments, const std::string &str) {
-        std::vector<uint8_t> data(numSegments, 0);
+    using SegmentTable = std::array<uint8_t, 128>;
 
-        for (int i = 0; i < std::min(numSegments, static_cast<int>(str.length())); i++) {
-            data[numSegments - 1 - i] = getSegmentRepresentation(str[i]);
+    // Lower case characters share the upper case segments
+    constexpr SegmentTable buildTable(uint8_t (*mapping)(char)) {
+        SegmentTable table = {};
+        for (int i = 0; i < static_cast<int>(table.size()); i++) {
+            char c = static_cast<char>(i);
+            table[i] = mapping(c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c);
         }
-
-        return data;
+        return table;
     }
 
-    std::vector<uint8_t> encodeStringSwapped(int numSegments, const std::string &str) {
-        std::vector<uint8_t> data = encodeString(numSegments, str);
-        data.push_back(0); // Add extra byte
+    constexpr SegmentTable representationTable = buildTable(segmentRepresentationFor);
+    constexpr SegmentTable maskTable = buildTable(segmentMaskFor);
+    constexpr SegmentTable efisTable = buildTable(efisRepresentationFor);
 
-        // Fix weird segment mapping
-        for (int i = 0; i < data.size(); i++) {
-            data[i] = swapNibbles(data[i]);
-        }
+    inline uint8_t lookup(const SegmentTable &table, char c) {
+        unsigned char index = static_cast<unsigned char>(c);
+        return index < table.size() ? table[index] : 0x00;
+    }
 
-        for (int i = 0; i < data.size() - 1; i++) {
-            data[numSegments - i] = (data[numSegments - i] & 0x0F) | (data[numSegments - 1 - i] & 0xF0);
-            data[numSegments - 1 - i] = data[numSegments - 1 - i] & 0x0F;
-        }
+    uint8_t getSegmentRepresentation(char c) {
+        return lookup(representationTable, c);
+    }
 
-        return data;
+    uint8_t getSegmentMask(char c) {
+        return lookup(maskTable, c);
     }
 
-    std::vector<uint8_t> encodeStringEfis(int numSegments, const std::string &str) {
-        std::vector<uint8_t> data = encodeString(numSegments, str);
-        std::vector<uint8_t> result(numSegments, 0);
+    uint8_t swapNibbles(uint8_t value) {
+        return ((value & 0x0F) << 4) | ((value & 0xF0) >> 4);
+    }
 
-        // Fix weird segment mapping for EFIS displays
-        for (int i = 0; i < data.size(); i++) {
-            result[i] |= (data[i] & 0x08) ? 0x01 : 0; // Upper left -> bit 0
-            result[i] |= (data[i] & 0x04) ? 0x02 : 0; // Middle -> bit 1
-            result[i] |= (data[i] & 0x02) ? 0x04 : 0; // Lower left -> bit 2
-            result[i] |= (data[i] & 0x10) ? 0x08 : 0; // Bottom -> bit 3
-            result[i] |= (data[i] & 0x80) ? 0x10 : 0; // Top -> bit 4
-            result[i] |= (data[i] & 0x40) ? 0x20 : 0; // Upper right -> bit 5
-            result[i] |= (data[i] & 0x20) ? 0x40 : 0; // Lower right -> bit 6
-            result[i] |= (data[i] & 0x01) ? 0x80 : 0; // Dot -> bit 7
+    void writeText(std::span<char> out, std::string_view text, char fillChar) {
+        if (text.size() > out.size()) {
+            text = text.substr(text.size() - out.size());
         }
 
-        return result;
+        size_t padding = out.size() - text.size();
+        std::fill(out.begin(), out.begin() + padding, fillChar);
+        std::copy(text.begin(), text.end(), out.begin() + padding);
     }
 
-    std::vector<uint8_t> encodeStringAGP(int numSegments, const std::string &str) {
-        // ===================================================================
-        // AGP 7-SEGMENT BINARY ENCODING
-        // ===================================================================
-        // Based on PAP3-MCP protocol analysis, AGP uses binary 7-segment encoding
-        // where each bit in the 16-bit value controls a specific segment.
-        //
-        // Similar to PAP3-MCP which uses segment order: Mid-TopL-BotL-Bot-BotR-TopR-Top
-        // AGP appears to use a scrambled/position-dependent bit mapping.
-        //
-        // Each position gets 4 bytes: [low_byte, high_byte, 0x00, 0x00]
-        // The 16-bit value (low | high<<8) encodes:
-        //   - 7 segment bits (a,b,c,d,e,f,g)
-        //   - Position/state flags (CHR active, display enable, etc.)
-        //
-        // Standard 7-segment layout:
-        //      aaa
-        //     f   b
-        //      ggg
-        //     e   c
-        //      ddd
-        std::vector<uint8_t> result;
-        result.reserve(numSegments * 4);
-
-        std::string paddedStr = str;
-        if (paddedStr.length() > static_cast<size_t>(numSegments)) {
-            paddedStr = paddedStr.substr(paddedStr.length() - numSegments);
-        }
-        while (paddedStr.length() < static_cast<size_t>(numSegments)) {
-            paddedStr = " " + paddedStr;
+    void writeNumber(std::span<char> out, int value, char fillChar, std::string_view suffix) {
+        if (suffix.size() >= out.size()) {
+            writeText(out, suffix, fillChar);
+            return;
         }
 
-        // AGP position-specific encoding maps (reverse-engineered from device captures)
-        // Format: 8 positions total
-        // Positions 0-1: CHR display (chronometer, when active)
-        // Positions 2-7: UTC time display (HHMMSS format)
-        // Position-specific maps based on confirmed observations
+        writeText(out.last(suffix.size()), suffix, fillChar);
+        auto digits = out.first(out.size() - suffix.size());
 
-        // ===================================================================
-        // CONFIRMED MAPPINGS from packet captures (15:46:16, 15:47:08, 15:47:10)
-        // ===================================================================
+        unsigned int remaining = static_cast<unsigned int>(std::abs(value));
+        size_t i = digits.size();
+        do {
+            digits[--i] = static_cast<char>('0' + remaining % 10);
+            remaining /= 10;
+        } while (remaining > 0 && i > 0);
 
-        // Position 2: Hours tens (0-2 for 24-hour format)
-        // CONFIRMED: 1 = 0x03F0 or 0x03FF (context-dependent)
-        static const std::map<char, uint16_t> pos2Map = {
-            {'0', 0x03F0}, // Estimate based on pattern
-            {'1', 0x03FF}, // CONFIRMED: 15:47:08, 15:47:10 (variant 0x03F0 at 15:46:16)
-            {'2', 0x02F0}, // Estimate based on frequency
-            {' ', 0x0000},
-        };
-
-        // Position 3: Hours ones (0-9)
-        // CONFIRMED: 5 = 0x02A0 or 0x022F (context-dependent)
-        static const std::map<char, uint16_t> pos3Map = {
-            {'0', 0x03A0}, // Estimate
-            {'1', 0x0320}, // Estimate
-            {'2', 0x012F}, // Estimate
-            {'3', 0x032F}, // Estimate
-            {'4', 0x022F}, // Estimate
-            {'5', 0x02A0}, // CONFIRMED: 15:46:16 (variant 0x022F at 15:47:08, 15:47:10)
-            {'6', 0x02A0}, // Estimate (same as 5 - needs more data)
-            {'7', 0x002F}, // Estimate
-            {'8', 0x0227}, // Estimate
-            {'9', 0x03A0}, // Estimate
-            {' ', 0x0000},
-        };
+        std::fill(digits.begin(), digits.begin() + i, fillChar);
+    }
 
-        // Position 4: Minutes tens (0-5 only)
-        // CONFIRMED: 4 = 0x0280 or 0x0207 (context-dependent!)
-        static const std::map<char, uint16_t> pos4Map = {
-            {'0', 0x0080}, // Estimate
-            {'1', 0x010F}, // Estimate
-            {'2', 0x0207}, // Estimate
-            {'3', 0x0307}, // Estimate
-            {'4', 0x0280}, // CONFIRMED: 15:46:16 (variant 0x0207 at 15:47:08, 15:47:10)
-            {'5', 0x0380}, // Estimate
-            {' ', 0x0000},
-        };
+    void writeFixed(std::span<char> out, float value, int decimals, char fillChar) {
+        int scaled = static_cast<int>(std::round(std::fabs(value) * std::pow(10.0f, decimals)));
+        writeNumber(out, scaled, '0');
 
-        // Position 5: Minutes ones (0-9)
-        // CONFIRMED: 6 = 0x02E0, 7 = 0x026F
-        static const std::map<char, uint16_t> pos5Map = {
-            {'0', 0x00E0}, // Estimate
-            {'1', 0x006F}, // Estimate
-            {'2', 0x0167}, // Estimate
-            {'3', 0x0367}, // Estimate
-            {'4', 0x03E0}, // Estimate
-            {'5', 0x026F}, // Estimate
-            {'6', 0x02E0}, // CONFIRMED: 15:46:16
-            {'7', 0x026F}, // CONFIRMED: 15:47:08, 15:47:10
-            {'8', 0x01E0}, // Estimate
-            {'9', 0x036F}, // Estimate
-            {' ', 0x0000},
-        };
+        // Only the digits in front of the decimals are padded with fillChar
+        size_t firstSignificant = 0;
+        while (firstSignificant + decimals < out.size() && out[firstSignificant] == '0') {
+            out[firstSignificant++] = fillChar;
+        }
+    }
 
-        // Position 6: Seconds tens (0-5 only)
-        // CRITICAL: 0 and 1 BOTH use 0x0068 when CHR is active!
-        // When CHR OFF: digit 1 = 0x02E0
-        static const std::map<char, uint16_t> pos6Map = {
-            {'0', 0x0068}, // CONFIRMED: 15:47:08
-            {'1', 0x0068}, // CONFIRMED: 15:47:10 (variant 0x02E0 at 15:46:16 when CHR OFF)
-            {'2', 0x0260}, // Estimate
-            {'3', 0x0268}, // Estimate
-            {'4', 0x03E0}, // Estimate
-            {'5', 0x02E0}, // Estimate
-            {' ', 0x0000},
-        };
+    void encode(std::span<const char> text, std::span<uint8_t> out) {
+        std::fill(out.begin(), out.end(), 0);
 
-        // Position 7: Seconds ones (0-9)
-        // CRITICAL: Only CHR state bit changes! Digit NOT encoded here!
-        // CHR OFF: 0x01E0, CHR ON: 0x01EC (difference = 0x0C bit)
-        // CONFIRMED: 0, 6, 8 all share same encoding per CHR state
-        static const std::map<char, uint16_t> pos7Map = {
-            {'0', 0x01EC}, // CONFIRMED: 15:47:10 (CHR ON)
-            {'1', 0x01EC}, // Assume CHR typically ON
-            {'2', 0x01EC}, // Assume CHR typically ON
-            {'3', 0x01EC}, // Assume CHR typically ON
-            {'4', 0x01EC}, // Assume CHR typically ON
-            {'5', 0x01EC}, // Assume CHR typically ON
-            {'6', 0x01EC}, // Use 0x01E0 when CHR OFF (see 15:46:16)
-            {'7', 0x01EC}, // Assume CHR typically ON
-            {'8', 0x01EC}, // CONFIRMED: 15:47:08 (CHR ON)
-            {'9', 0x01EC}, // Assume CHR typically ON
-            {' ', 0x0000},
-        };
+        size_t count = std::min(text.size(), out.size());
+        for (size_t i = 0; i < count; i++) {
+            out[out.size() - 1 - i] = lookup(representationTable, text[i]);
+        }
+    }
 
-        // Use confirmed empirical mappings (binary encoding is position-dependent)
-        // TODO: Decode the exact bit-to-segment mapping once more packet data is available
-        const std::map<char, uint16_t> *positionMaps[] = {
-            &pos2Map, &pos3Map, &pos4Map, &pos5Map, &pos6Map, &pos7Map, &pos7Map, &pos7Map};
+    void encodeSwapped(std::span<const char> text, std::span<uint8_t> out) {
+        // Each digit spans two bytes: its upper nibble goes into its own byte, its lower nibble into the upper half of the next byte
+        std::fill(out.begin(), out.end(), 0);
 
-        for (int i = 0; i < numSegments; ++i) {
-            char c = std::toupper(paddedStr[i]);
-            uint16_t agpValue = 0x0000;
+        size_t count = std::min(text.size(), out.size() - 1);
+        uint8_t previous = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint8_t segments = lookup(representationTable, text[count - 1 - i]);
+            out[i] = (segments >> 4) | ((previous & 0x0F) << 4);
+            previous = segments;
+        }
+        out[count] = (previous & 0x0F) << 4;
+    }
 
-            // Use position-specific map if available
-            if (i < 8 && positionMaps[i] != nullptr) {
-                auto it = positionMaps[i]->find(c);
-                if (it != positionMaps[i]->end()) {
-                    agpValue = it->second;
-                }
-            }
+    void encodeEfis(std::span<const char> text, std::span<uint8_t> out) {
+        std::fill(out.begin(), out.end(), 0);
 
-            // AGP format: [low_byte, high_byte, 0x00, 0x00] per position
-            result.push_back(agpValue & 0xFF);        // Low byte
-            result.push_back((agpValue >> 8) & 0xFF); // High byte
-            result.push_back(0x00);                   // Reserved
-            result.push_back(0x00);                   // Reserved
+        size_t count = std::min(text.size(), out.size());
+        for (size_t i = 0; i < count; i++) {
+            out[out.size() - 1 - i] = lookup(efisTable, text[i]);
         }
+    }
 
+    std::string fixStringLength(const std::string &value, int length, char fillChar) {
+        std::string result(length, fillChar);
+        writeText(result, value, fillChar);
         return result;
     }
 }
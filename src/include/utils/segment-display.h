@@ -1,25 +1,40 @@
 #ifndef SEGMENT_DISPLAY_H
 #define SEGMENT_DISPLAY_H
 
+#include <array>
 #include <cstdint>
+#include <span>
 #include <string>
-#include <vector>
+#include <string_view>
 
 namespace SegmentDisplay {
 
+    // Fixed width display field, characters from left to right as they appear on the display
+    template<size_t N>
+    using Text = std::array<char, N>;
+
     // Get 7-segment representation for a character
     uint8_t getSegmentRepresentation(char c);
 
     uint8_t getSegmentMask(char c);
 
-    // Basic 7-segment string encoding (right-aligned)
-    std::vector<uint8_t> encodeString(int numSegments, const std::string &str);
+    // Write text right-aligned, keeping the rightmost characters and padding on the left with fillChar
+    void writeText(std::span<char> out, std::string_view text, char fillChar = '0');
+
+    // Write the digits of abs(value) right-aligned in front of suffix, keeping the least significant digits and padding on the left with fillChar
+    void writeNumber(std::span<char> out, int value, char fillChar = '0', std::string_view suffix = {});
+
+    // Write abs(value) rounded to the given number of decimals without a decimal point, e.g. 0.78 with 2 decimals as " 78"
+    void writeFixed(std::span<char> out, float value, int decimals, char fillChar = ' ');
 
-    // Swapped nibble encoding (for some displays)
-    std::vector<uint8_t> encodeStringSwapped(int numSegments, const std::string &str);
+    // Basic 7-segment encoding, the last character ends up in the first byte
+    void encode(std::span<const char> text, std::span<uint8_t> out);
+
+    // Swapped nibble encoding (for some displays), out holds one byte more than text
+    void encodeSwapped(std::span<const char> text, std::span<uint8_t> out);
 
     // EFIS-specific bit mapping
-    std::vector<uint8_t> encodeStringEfis(int numSegments, const std::string &str);
+    void encodeEfis(std::span<const char> text, std::span<uint8_t> out);
 
     // Fix string length with leading zeros
     std::string fixStringLength(const std::string &value, int length, char fillChar = '0');
@@ -27,9 +42,6 @@ namespace SegmentDisplay {
     // Swap nibbles in a byte
     uint8_t swapNibbles(uint8_t value);
 
-    // AGP 2-byte per digit encoding (little-endian format)
-    std::vector<uint8_t> encodeStringAGP(int numSegments, const std::string &str);
-
 }
 
 #endif
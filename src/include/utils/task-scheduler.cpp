@@ -0,0 +1,107 @@
+#include "task-scheduler.h"
+
+#include <algorithm>
+
+// Orders the heap so the earliest task is in front, tasks due at the same time run in the order they were scheduled
+static constexpr auto laterThan = [](const auto &a, const auto &b) {
+    return a.runAt > b.runAt || (a.runAt == b.runAt && a.handle > b.handle);
+};
+
+TaskHandle TaskScheduler::schedule(Clock::time_point runAt, std::function<void()> func) {
+    TaskHandle handle = nextHandle++;
+    tasks.emplace(handle, PendingTask{.func = std::move(func), .debounceKey = ""});
+    push(runAt, handle);
+    return handle;
+}
+
+TaskHandle TaskScheduler::scheduleDebounced(const std::string &key, Clock::time_point runAt, std::function<void()> func) {
+    auto existing = debounced.find(key);
+    if (existing != debounced.end()) {
+        tasks.erase(existing->second);
+    }
+
+    TaskHandle handle = nextHandle++;
+    tasks.emplace(handle, PendingTask{.func = std::move(func), .debounceKey = key});
+    debounced[key] = handle;
+    push(runAt, handle);
+    return handle;
+}
+
+bool TaskScheduler::cancel(TaskHandle handle) {
+    auto it = tasks.find(handle);
+    if (it == tasks.end()) {
+        return false;
+    }
+
+    forget(it);
+    return true;
+}
+
+void TaskScheduler::runDue(Clock::time_point now) {
+    TaskHandle lastHandle = nextHandle;
+    std::vector<HeapEntry> deferred;
+
+    while (!heap.empty() && heap.front().runAt <= now) {
+        std::pop_heap(heap.begin(), heap.end(), laterThan);
+        HeapEntry entry = heap.back();
+        heap.pop_back();
+
+        // Scheduled by a task in this run, set aside so it cannot hold up older due tasks behind it
+        if (entry.handle >= lastHandle) {
+            deferred.push_back(entry);
+            continue;
+        }
+
+        auto it = tasks.find(entry.handle);
+        if (it == tasks.end()) {
+            continue;
+        }
+
+        // Removed before it runs, so the task can schedule or debounce itself again
+        std::function<void()> func = std::move(it->second.func);
+        forget(it);
+
+        if (func) {
+            func();
+        }
+    }
+
+    for (const HeapEntry &entry : deferred) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), laterThan);
+    }
+}
+
+void TaskScheduler::clear() {
+    heap.clear();
+    tasks.clear();
+    debounced.clear();
+}
+
+size_t TaskScheduler::pendingCount() const {
+    return tasks.size();
+}
+
+void TaskScheduler::push(Clock::time_point runAt, TaskHandle handle) {
+    // Drop the leftovers of cancelled tasks once they outnumber the live ones
+    if (heap.size() > CompactThreshold && heap.size() > tasks.size() * 2) {
+        std::erase_if(heap, [this](const HeapEntry &entry) {
+            return !tasks.contains(entry.handle);
+        });
+        std::make_heap(heap.begin(), heap.end(), laterThan);
+    }
+
+    heap.push_back({.runAt = runAt, .handle = handle});
+    std::push_heap(heap.begin(), heap.end(), laterThan);
+}
+
+void TaskScheduler::forget(std::unordered_map<TaskHandle, PendingTask>::iterator it) {
+    if (!it->second.debounceKey.empty()) {
+        auto key = debounced.find(it->second.debounceKey);
+        if (key != debounced.end() && key->second == it->first) {
+            debounced.erase(key);
+        }
+    }
+
+    tasks.erase(it);
+}
@@ -0,0 +1,59 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 0 is never handed out, so it can be used for "no task"
+using TaskHandle = uint64_t;
+
+// Delayed tasks ordered in a min-heap by due time. Checking for due work is O(1) while nothing is due.
+// Cancelled and re-debounced tasks leave their heap entry behind, it is dropped once it comes due.
+class TaskScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TaskScheduler() = default;
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+        TaskHandle schedule(Clock::time_point runAt, std::function<void()> func);
+
+        // Replaces a pending task with the same key, so only the last one runs
+        TaskHandle scheduleDebounced(const std::string &key, Clock::time_point runAt, std::function<void()> func);
+
+        bool cancel(TaskHandle handle);
+
+        // Tasks scheduled while this runs are left for the next call, even when already due
+        void runDue(Clock::time_point now);
+
+        void clear();
+        size_t pendingCount() const;
+
+    private:
+        static constexpr size_t CompactThreshold = 64;
+
+        struct HeapEntry {
+                Clock::time_point runAt;
+                TaskHandle handle;
+        };
+
+        struct PendingTask {
+                std::function<void()> func;
+                std::string debounceKey;
+        };
+
+        std::vector<HeapEntry> heap;
+        std::unordered_map<TaskHandle, PendingTask> tasks;
+        std::unordered_map<std::string, TaskHandle> debounced;
+        TaskHandle nextHandle = 1;
+
+        void push(Clock::time_point runAt, TaskHandle handle);
+        void forget(std::unordered_map<TaskHandle, PendingTask>::iterator it);
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "usb-telemetry.h"
+
+#include "config.h"
+#include "dataref.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+struct TelemetryDataref {
+        const char *name;
+        float UsbTelemetrySummary::*value;
+};
+
+static constexpr TelemetryDataref telemetryDatarefs[] = {
+    {"reports_in_per_sec", &UsbTelemetrySummary::reportsInPerSecond},
+    {"reports_out_per_sec", &UsbTelemetrySummary::reportsOutPerSecond},
+    {"bytes_in_per_sec", &UsbTelemetrySummary::bytesInPerSecond},
+    {"bytes_out_per_sec", &UsbTelemetrySummary::bytesOutPerSecond},
+    {"superseded_per_sec", &UsbTelemetrySummary::supersededPerSecond},
+    {"dropped_per_sec", &UsbTelemetrySummary::droppedPerSecond},
+    {"queue_depth_min", &UsbTelemetrySummary::queueDepthMin},
+    {"queue_depth_avg", &UsbTelemetrySummary::queueDepthAvg},
+    {"queue_depth_max", &UsbTelemetrySummary::queueDepthMax},
+    {"write_p50_ms", &UsbTelemetrySummary::writeP50},
+    {"write_p99_ms", &UsbTelemetrySummary::writeP99},
+    {"write_max_ms", &UsbTelemetrySummary::writeMax},
+    {"render_avg_ms", &UsbTelemetrySummary::renderAvg},
+    {"render_max_ms", &UsbTelemetrySummary::renderMax},
+};
+
+struct ConnectionHistory {
+        bool connected = false;
+        int reconnects = 0;
+};
+
+// Devices are recreated when they are plugged in again, so the history is kept per device key.
+// Linux connects devices from the udev monitor thread, hence the mutex.
+static std::unordered_map<std::string, ConnectionHistory> connectionHistory;
+static std::mutex connectionHistoryMutex;
+
+UsbTelemetry::~UsbTelemetry() {
+    unbindDatarefs();
+}
+
+void UsbTelemetry::recordInput(size_t bytes) {
+    reportsIn.fetch_add(1, std::memory_order_relaxed);
+    bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void UsbTelemetry::recordWrite(size_t bytes, Clock::time_point queuedAt) {
+    reportsOut.fetch_add(1, std::memory_order_relaxed);
+    bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+
+    if (queuedAt != Clock::time_point{}) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - queuedAt).count();
+        writeLatency.record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+    }
+}
+
+void UsbTelemetry::recordSuperseded(size_t packets) {
+    superseded.fetch_add(packets, std::memory_order_relaxed);
+}
+
+void UsbTelemetry::recordDropped(size_t packets) {
+    dropped.fetch_add(packets, std::memory_order_relaxed);
+}
+
+void UsbTelemetry::recordRender(Clock::duration elapsed) {
+    renderTotal += elapsed;
+    renderMax = std::max(renderMax, elapsed);
+    renderCount++;
+}
+
+void UsbTelemetry::recordConnected(const std::string &deviceKey) {
+    std::lock_guard<std::mutex> lock(connectionHistoryMutex);
+    auto [it, inserted] = connectionHistory.try_emplace(deviceKey);
+    if (!inserted && !it->second.connected) {
+        it->second.reconnects++;
+    }
+    it->second.connected = true;
+    reconnects.store(it->second.reconnects, std::memory_order_relaxed);
+}
+
+void UsbTelemetry::recordDisconnected(const std::string &deviceKey) {
+    std::lock_guard<std::mutex> lock(connectionHistoryMutex);
+    auto it = connectionHistory.find(deviceKey);
+    if (it != connectionHistory.end()) {
+        it->second.connected = false;
+    }
+}
+
+void UsbTelemetry::resetConnectionHistory() {
+    std::lock_guard<std::mutex> lock(connectionHistoryMutex);
+    connectionHistory.clear();
+}
+
+const UsbTelemetrySummary &UsbTelemetry::summary() const {
+    return summaries;
+}
+
+void UsbTelemetry::publish(const std::string &deviceKey, size_t queueDepth) {
+    if (boundPrefix.empty()) {
+        bindDatarefs(deviceKey);
+    }
+    summaries.reconnects = reconnects.load(std::memory_order_relaxed);
+
+    queueDepthMin = std::min(queueDepthMin, queueDepth);
+    queueDepthMax = std::max(queueDepthMax, queueDepth);
+    queueDepthTotal += queueDepth;
+    queueDepthSamples++;
+
+    auto now = Clock::now();
+    if (lastPublish == Clock::time_point{}) {
+        lastPublish = now;
+        return;
+    }
+
+    if (now - lastPublish < std::chrono::milliseconds(PublishIntervalMs)) {
+        return;
+    }
+
+    float seconds = std::chrono::duration<float>(now - lastPublish).count();
+    lastPublish = now;
+
+    summaries.reportsInPerSecond = reportsIn.exchange(0, std::memory_order_relaxed) / seconds;
+    summaries.reportsOutPerSecond = reportsOut.exchange(0, std::memory_order_relaxed) / seconds;
+    summaries.bytesInPerSecond = bytesIn.exchange(0, std::memory_order_relaxed) / seconds;
+    summaries.bytesOutPerSecond = bytesOut.exchange(0, std::memory_order_relaxed) / seconds;
+    summaries.supersededPerSecond = superseded.exchange(0, std::memory_order_relaxed) / seconds;
+    summaries.droppedPerSecond = dropped.exchange(0, std::memory_order_relaxed) / seconds;
+
+    summaries.queueDepthMin = static_cast<float>(queueDepthMin);
+    summaries.queueDepthMax = static_cast<float>(queueDepthMax);
+    summaries.queueDepthAvg = static_cast<float>(queueDepthTotal) / queueDepthSamples;
+    queueDepthMin = SIZE_MAX;
+    queueDepthMax = 0;
+    queueDepthTotal = 0;
+    queueDepthSamples = 0;
+
+    summaries.writeP50 = writeLatency.percentile(50.0) / 1000.0f;
+    summaries.writeP99 = writeLatency.percentile(99.0) / 1000.0f;
+    summaries.writeMax = writeLatency.max() / 1000.0f;
+    writeLatency.reset();
+
+    summaries.renderAvg = renderCount > 0 ? std::chrono::duration<float, std::milli>(renderTotal).count() / renderCount : 0.0f;
+    summaries.renderMax = std::chrono::duration<float, std::milli>(renderMax).count();
+    renderTotal = Clock::duration::zero();
+    renderMax = Clock::duration::zero();
+    renderCount = 0;
+}
+
+void UsbTelemetry::bindDatarefs(const std::string &deviceKey) {
+    boundPrefix = std::string(PRODUCT_NAME "/stats/") + deviceKey + "/";
+
+    for (const auto &dataref : telemetryDatarefs) {
+        Dataref::getInstance()->createDataref<float>((boundPrefix + dataref.name).c_str(), &(summaries.*dataref.value));
+    }
+    Dataref::getInstance()->createDataref<int>((boundPrefix + "reconnects").c_str(), &summaries.reconnects);
+}
+
+void UsbTelemetry::unbindDatarefs() {
+    if (boundPrefix.empty()) {
+        return;
+    }
+
+    for (const auto &dataref : telemetryDatarefs) {
+        Dataref::getInstance()->unbind((boundPrefix + dataref.name).c_str(), &(summaries.*dataref.value));
+    }
+    Dataref::getInstance()->unbind((boundPrefix + "reconnects").c_str(), &summaries.reconnects);
+
+    boundPrefix.clear();
+}
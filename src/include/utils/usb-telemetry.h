@@ -0,0 +1,82 @@
+#ifndef USB_TELEMETRY_H
+#define USB_TELEMETRY_H
+
+#include "latency-tracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct UsbTelemetrySummary {
+        float reportsInPerSecond = 0.0f;
+        float reportsOutPerSecond = 0.0f;
+        float bytesInPerSecond = 0.0f;
+        float bytesOutPerSecond = 0.0f;
+        float supersededPerSecond = 0.0f;
+        float droppedPerSecond = 0.0f;
+        float queueDepthMin = 0.0f;
+        float queueDepthAvg = 0.0f;
+        float queueDepthMax = 0.0f;
+        float writeP50 = 0.0f; // ms, queued -> written
+        float writeP99 = 0.0f;
+        float writeMax = 0.0f;
+        float renderAvg = 0.0f; // ms
+        float renderMax = 0.0f;
+        int reconnects = 0;
+};
+
+// Counters for one device's USB pipeline. The input and write threads only bump atomics,
+// the main thread samples the queue depth once per frame and publishes under <product>/stats/<device>/.
+class UsbTelemetry {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr int PublishIntervalMs = 1000;
+
+        UsbTelemetry() = default;
+        ~UsbTelemetry();
+        UsbTelemetry(const UsbTelemetry &) = delete;
+        UsbTelemetry &operator=(const UsbTelemetry &) = delete;
+
+        void recordInput(size_t bytes);
+        void recordWrite(size_t bytes, Clock::time_point queuedAt);
+        void recordSuperseded(size_t packets);
+        void recordDropped(size_t packets = 1);
+        void recordConnected(const std::string &deviceKey);
+        void recordDisconnected(const std::string &deviceKey);
+
+        // Forgets which devices were connected before, so reopening the plugin does not count as a reconnect
+        static void resetConnectionHistory();
+
+        // Main thread only
+        void recordRender(Clock::duration elapsed);
+        void publish(const std::string &deviceKey, size_t queueDepth);
+        const UsbTelemetrySummary &summary() const;
+
+    private:
+        std::atomic<uint64_t> reportsIn{0};
+        std::atomic<uint64_t> reportsOut{0};
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+        std::atomic<uint64_t> superseded{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<int> reconnects{0};
+        LatencyHistogram writeLatency;
+
+        size_t queueDepthMin = SIZE_MAX;
+        size_t queueDepthMax = 0;
+        uint64_t queueDepthTotal = 0;
+        uint64_t queueDepthSamples = 0;
+        Clock::duration renderTotal = Clock::duration::zero();
+        Clock::duration renderMax = Clock::duration::zero();
+        uint64_t renderCount = 0;
+
+        UsbTelemetrySummary summaries;
+        std::string boundPrefix;
+        Clock::time_point lastPublish;
+
+        void bindDatarefs(const std::string &deviceKey);
+        void unbindDatarefs();
+};
+
+#endif
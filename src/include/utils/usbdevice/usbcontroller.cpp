@@ -26,3 +26,9 @@ void USBController::disconnectAllDevices() {
     }
     devices.clear();
 }
+
+void USBController::unloadAllProfiles() {
+    for (auto ptr : devices) {
+        ptr->unloadProfile();
+    }
+}
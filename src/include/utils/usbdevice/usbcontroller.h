@@ -66,6 +66,7 @@ class USBController {
         bool anyProfileReady();
         void connectAllDevices();
         void disconnectAllDevices();
+        void unloadAllProfiles();
 };
 
 #endif
@@ -10,8 +10,15 @@
 #include "product-ursa-minor-joystick.h"
 #include "product-ursa-minor-throttle.h"
 
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
 #include <XPLMUtilities.h>
 
+static std::map<uint16_t, std::set<int>> usedDeviceSlots;
+static std::mutex usedDeviceSlotsMutex;
+
 // The desktop app overrides this function to get notified of button presses
 __attribute__((weak)) void notifyButtonPressed(uint16_t buttonId, uint16_t productId) {}
 
@@ -132,15 +139,29 @@ const char *USBDevice::classIdentifier() {
     return "USBDevice (none)";
 }
 
+void USBDevice::render() {
+    // noop, expect override
+}
+
 void USBDevice::blackout() {
     // noop, expect override
 }
 
+void USBDevice::setProfileForCurrentAircraft() {
+    // noop, expect override
+}
+
+void USBDevice::unloadProfile() {
+    // noop, expect override
+}
+
 void USBDevice::didReceiveData(int reportId, uint8_t *report, int reportLength) {
     // noop, expect override
 }
 
 void USBDevice::didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count) {
+    LatencyTracker::markDispatch();
+
     if (pressed) {
         notifyButtonPressed(hardwareButtonIndex, this->productId);
     }
@@ -151,6 +172,9 @@ void USBDevice::processOnMainThread(const InputEvent &event) {
         return;
     }
 
+    latency.record(LatencyStage::INPUT_ENQUEUE, event.readAt);
+    telemetry.recordInput(event.reportLength);
+
     std::lock_guard<std::mutex> lock(eventQueueMutex);
     eventQueue.push(event);
 }
@@ -161,7 +185,106 @@ void USBDevice::processQueuedEvents() {
         InputEvent event = eventQueue.front();
         eventQueue.pop();
 
+        latency.record(LatencyStage::INPUT_DEQUEUE, event.readAt);
+        latency.beginInput(event.readAt);
         didReceiveData(event.reportId, event.reportData.data(), event.reportLength);
+        LatencyTracker::endInput();
+    }
+}
+
+bool USBDevice::writeData(std::vector<uint8_t> data) {
+    return writeData(std::move(data), latency.outputOrigin());
+}
+
+bool USBDevice::writeData(const uint8_t *data, size_t length) {
+    // Reuse a buffer the write thread is done with, so steady state output does not allocate
+    std::vector<uint8_t> buffer;
+    {
+        std::lock_guard<std::mutex> lock(writeQueueMutex);
+        if (!spareWriteBuffers.empty()) {
+            buffer = std::move(spareWriteBuffers.back());
+            spareWriteBuffers.pop_back();
+        }
+    }
+
+    buffer.assign(data, data + length);
+    return writeData(std::move(buffer));
+}
+
+bool USBDevice::writeTransaction(uint32_t key, std::vector<std::vector<uint8_t>> packets) {
+    return writeTransaction(key, std::move(packets), latency.outputOrigin());
+}
+
+bool USBDevice::writeTransaction(uint32_t key, std::vector<std::vector<uint8_t>> packets, std::chrono::steady_clock::time_point changedAt) {
+    if (!connected || key == 0 || packets.empty()) {
+        return false;
+    }
+
+    latency.record(LatencyStage::OUTPUT_ENQUEUE, changedAt);
+
+    {
+        std::lock_guard<std::mutex> lock(writeQueueMutex);
+        if (!connected || !writeThreadRunning) {
+            telemetry.recordDropped(packets.size());
+            return false;
+        }
+
+        // A queued transaction for the same key that was not started yet is superseded, its packets are swapped in place.
+        // The latency is then measured from the newer change, the queue position is kept.
+        auto it = pendingTransactions.find(key);
+        if (it != pendingTransactions.end() && it->second.size() == packets.size()) {
+            auto queuedAt = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < packets.size(); i++) {
+                std::swap(it->second[i]->data, packets[i]);
+                it->second[i]->changedAt = changedAt;
+                it->second[i]->queuedAt = queuedAt;
+            }
+
+            skippedPacketCount += packets.size();
+            telemetry.recordSuperseded(packets.size());
+            return true;
+        }
+
+        auto &queued = pendingTransactions[key];
+        queued.clear();
+        auto queuedAt = std::chrono::steady_clock::now();
+        for (auto &packet : packets) {
+            writeQueue.push({.data = std::move(packet), .changedAt = changedAt, .queuedAt = queuedAt, .transactionKey = key});
+            queued.push_back(&writeQueue.back());
+        }
+        writeQueueSize.store(writeQueue.size());
+    }
+    writeQueueCV.notify_one();
+
+    return true;
+}
+
+void USBDevice::popWriteQueue(std::vector<uint8_t> &data, std::chrono::steady_clock::time_point &changedAt, std::chrono::steady_clock::time_point &queuedAt) {
+    OutputPacket &packet = writeQueue.front();
+
+    // Once the first packet of a transaction is taken, the transaction can no longer be replaced
+    if (packet.transactionKey) {
+        auto it = pendingTransactions.find(packet.transactionKey);
+        if (it != pendingTransactions.end() && it->second.front() == &packet) {
+            pendingTransactions.erase(it);
+        }
+    }
+
+    data = std::move(packet.data);
+    changedAt = packet.changedAt;
+    queuedAt = packet.queuedAt;
+    writeQueue.pop();
+    writeQueueSize.store(writeQueue.size());
+}
+
+void USBDevice::recycleWriteBuffer(std::vector<uint8_t> &&buffer) {
+    if (buffer.capacity() == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(writeQueueMutex);
+    if (spareWriteBuffers.size() < MaxSpareWriteBuffers) {
+        spareWriteBuffers.push_back(std::move(buffer));
     }
 }
 
@@ -169,23 +292,54 @@ size_t USBDevice::getWriteQueueSize() {
     return writeQueueSize.load();
 }
 
-int USBDevice::getDisplayUpdateFrameInterval(int minWaitFrames) {
+int USBDevice::getDisplayRefreshBackoff() {
     size_t queueSize = writeQueueSize.load();
 
-    int interval;
+    // Multiplier on the refresh interval while the device is still busy writing earlier frames
+    int backoff;
     if (queueSize < 50) {
-        interval = 2;
+        backoff = 1;
     } else if (queueSize < 250) {
-        interval = 4;
+        backoff = 2;
     } else if (queueSize < 500) {
-        interval = 8;
+        backoff = 4;
     } else if (queueSize < 1000) {
-        interval = 16;
+        backoff = 8;
     } else if (queueSize < 2000) {
-        interval = 32;
+        backoff = 16;
     } else {
-        interval = 100;
+        backoff = 50;
+    }
+
+    return backoff;
+}
+
+const std::string &USBDevice::deviceKey() {
+    if (deviceKeyName.empty()) {
+        std::lock_guard<std::mutex> lock(usedDeviceSlotsMutex);
+        auto &used = usedDeviceSlots[productId];
+        int slot = 0;
+        while (used.contains(slot)) {
+            slot++;
+        }
+        used.insert(slot);
+        deviceSlot = slot;
+
+        char key[16];
+        snprintf(key, sizeof(key), "%04x-%d", productId, slot);
+        deviceKeyName = key;
+    }
+
+    return deviceKeyName;
+}
+
+void USBDevice::releaseDeviceKey() {
+    if (deviceSlot < 0) {
+        return;
     }
 
-    return std::max(interval, minWaitFrames);
+    std::lock_guard<std::mutex> lock(usedDeviceSlotsMutex);
+    usedDeviceSlots[productId].erase(deviceSlot);
+    deviceSlot = -1;
+    deviceKeyName.clear();
 }
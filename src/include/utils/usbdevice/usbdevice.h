@@ -2,10 +2,14 @@
 #define USBDEVICE_H
 
 #include "config.h"
+#include "latency-tracker.h"
+#include "usb-telemetry.h"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <map>
 #include <mutex>
 #include <queue>
 #include <string>
@@ -29,6 +33,14 @@ struct InputEvent {
         int reportId;
         std::vector<uint8_t> reportData;
         int reportLength;
+        std::chrono::steady_clock::time_point readAt;
+};
+
+struct OutputPacket {
+        std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point changedAt;
+        std::chrono::steady_clock::time_point queuedAt;
+        uint32_t transactionKey = 0;
 };
 
 class USBDevice {
@@ -37,15 +49,26 @@ class USBDevice {
         std::queue<InputEvent> eventQueue;
         std::mutex eventQueueMutex;
 
-        std::queue<std::vector<uint8_t>> writeQueue;
+        std::queue<OutputPacket> writeQueue;
         std::mutex writeQueueMutex;
         std::condition_variable writeQueueCV;
         std::thread writeThread;
         std::atomic<bool> writeThreadRunning{false};
         std::atomic<size_t> writeQueueSize{0};
+        std::vector<std::vector<uint8_t>> spareWriteBuffers;
+        static constexpr size_t MaxSpareWriteBuffers = 64;
+        // Packets of transactions that were queued but not started yet, by transaction key. The pointers stay valid
+        // because the write queue only ever pushes at the back and pops at the front, and popWriteQueue drops the
+        // entry when the first packet of its transaction is popped. Both happen under writeQueueMutex.
+        std::map<uint32_t, std::vector<OutputPacket *>> pendingTransactions;
+        int deviceSlot = -1;
+        std::string deviceKeyName;
 
         void processQueuedEvents();
         void writeThreadLoop();
+        void popWriteQueue(std::vector<uint8_t> &data, std::chrono::steady_clock::time_point &changedAt, std::chrono::steady_clock::time_point &queuedAt);
+        void recycleWriteBuffer(std::vector<uint8_t> &&buffer);
+        void releaseDeviceKey();
 
 #if APL
         IOHIDQueueRef hidQueue;
@@ -62,28 +85,44 @@ class USBDevice {
         virtual ~USBDevice();
 
         HIDDeviceHandle hidDevice;
-        bool connected = false;
+        std::atomic<bool> connected{false};
         bool profileReady = false;
         uint16_t vendorId;
         uint16_t productId;
         std::string vendorName;
         std::string productName;
+        LatencyTracker latency;
+        UsbTelemetry telemetry;
+        std::atomic<uint64_t> skippedPacketCount{0};
 
         virtual const char *classIdentifier();
         virtual bool connect();
         void disconnect();
         virtual void update();
+        virtual void render();
         virtual void didReceiveData(int reportId, uint8_t *report, int reportLength);
         virtual void didReceiveButton(uint16_t hardwareButtonIndex, bool pressed, uint8_t count = 1);
 
         virtual void blackout();
         virtual void forceStateSync();
+        virtual void setProfileForCurrentAircraft();
+        virtual void unloadProfile();
 
         void processOnMainThread(const InputEvent &event);
 
         bool writeData(std::vector<uint8_t> data);
+        bool writeData(const uint8_t *data, size_t length);
+        bool writeTransaction(uint32_t key, std::vector<std::vector<uint8_t>> packets);
+
+        // For writes made off the main thread, changedAt is the latency origin captured on the main thread
+        bool writeData(std::vector<uint8_t> data, std::chrono::steady_clock::time_point changedAt);
+        bool writeTransaction(uint32_t key, std::vector<std::vector<uint8_t>> packets, std::chrono::steady_clock::time_point changedAt);
+
         size_t getWriteQueueSize();
-        int getDisplayUpdateFrameInterval(int minWaitFrames = 0);
+        int getDisplayRefreshBackoff();
+
+        // Product id plus the lowest slot not taken by another connected device with the same product id, e.g. "bb36-0"
+        const std::string &deviceKey();
 
         static USBDevice *Device(HIDDeviceHandle hidDevice, uint16_t vendorId, uint16_t productId, std::string vendorName, std::string productName);
 };
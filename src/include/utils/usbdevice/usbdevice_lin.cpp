@@ -20,6 +20,7 @@ USBDevice::USBDevice(HIDDeviceHandle aHidDevice, uint16_t aVendorId, uint16_t aP
 
 USBDevice::~USBDevice() {
     disconnect();
+    releaseDeviceKey();
 }
 
 bool USBDevice::connect() {
@@ -31,6 +32,7 @@ bool USBDevice::connect() {
     inputBuffer = new uint8_t[kInputReportSize];
 
     connected = true;
+    telemetry.recordConnected(deviceKey());
     std::thread inputThread([this]() {
         uint8_t buffer[65];
         while (connected && hidDevice >= 0) {
@@ -60,6 +62,7 @@ bool USBDevice::connect() {
 }
 
 void USBDevice::InputReportCallback(void *context, int bytesRead, uint8_t *report) {
+    auto readAt = std::chrono::steady_clock::now();
     auto *self = static_cast<USBDevice *>(context);
     if (!self || !self->connected || !report || bytesRead <= 0) {
         return;
@@ -70,6 +73,7 @@ void USBDevice::InputReportCallback(void *context, int bytesRead, uint8_t *repor
         event.reportId = report[0];
         event.reportData.assign(report, report + bytesRead);
         event.reportLength = bytesRead;
+        event.readAt = readAt;
 
         self->processOnMainThread(event);
     } catch (const std::system_error &e) {
@@ -92,6 +96,9 @@ void USBDevice::disconnect() {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
+    if (connected) {
+        telemetry.recordDisconnected(deviceKey());
+    }
     connected = false;
     writeThreadRunning = false;
     writeQueueCV.notify_all();
@@ -116,15 +123,17 @@ void USBDevice::forceStateSync() {
     // noop, code does not use partial data
 }
 
-bool USBDevice::writeData(std::vector<uint8_t> data) {
+bool USBDevice::writeData(std::vector<uint8_t> data, std::chrono::steady_clock::time_point changedAt) {
     if (hidDevice < 0 || !connected || data.empty()) {
         debug("HID device not open, not connected, or empty data\n");
         return false;
     }
 
+    latency.record(LatencyStage::OUTPUT_ENQUEUE, changedAt);
+
     {
         std::lock_guard<std::mutex> lock(writeQueueMutex);
-        writeQueue.push(std::move(data));
+        writeQueue.push({.data = std::move(data), .changedAt = changedAt, .queuedAt = std::chrono::steady_clock::now()});
         writeQueueSize.store(writeQueue.size());
     }
     writeQueueCV.notify_one();
@@ -135,6 +144,8 @@ bool USBDevice::writeData(std::vector<uint8_t> data) {
 void USBDevice::writeThreadLoop() {
     while (writeThreadRunning) {
         std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point changedAt;
+        std::chrono::steady_clock::time_point queuedAt;
 
         {
             std::unique_lock<std::mutex> lock(writeQueueMutex);
@@ -147,9 +158,7 @@ void USBDevice::writeThreadLoop() {
             }
 
             if (!writeQueue.empty()) {
-                data = std::move(writeQueue.front());
-                writeQueue.pop();
-                writeQueueSize.store(writeQueue.size());
+                popWriteQueue(data, changedAt, queuedAt);
             }
         }
 
@@ -157,8 +166,14 @@ void USBDevice::writeThreadLoop() {
             ssize_t bytesWritten = write(hidDevice, data.data(), data.size());
             if (bytesWritten != (ssize_t) data.size()) {
                 debug_force("Raw write failed: %s (wrote %zd of %zu bytes)\n", strerror(errno), bytesWritten, data.size());
+                telemetry.recordDropped();
+            } else {
+                latency.record(LatencyStage::OUTPUT_WRITE, changedAt);
+                telemetry.recordWrite(data.size(), queuedAt);
             }
         }
+
+        recycleWriteBuffer(std::move(data));
     }
 }
 #endif
@@ -13,6 +13,7 @@ USBDevice::USBDevice(HIDDeviceHandle aHidDevice, uint16_t aVendorId, uint16_t aP
 
 USBDevice::~USBDevice() {
     disconnect();
+    releaseDeviceKey();
 }
 
 bool USBDevice::connect() {
@@ -49,6 +50,7 @@ bool USBDevice::connect() {
     }
 
     connected = true;
+    telemetry.recordConnected(deviceKey());
 
     writeThreadRunning = true;
     writeThread = std::thread(&USBDevice::writeThreadLoop, this);
@@ -67,7 +69,12 @@ void USBDevice::update() {
 
     IOHIDValueRef value = nullptr;
     while ((value = IOHIDQueueCopyNextValue(hidQueue))) {
+        // Values are polled on the main thread, so the read and dequeue timestamps coincide
+        auto readAt = std::chrono::steady_clock::now();
+        latency.record(LatencyStage::INPUT_DEQUEUE, readAt, readAt);
+        latency.beginInput(readAt);
         handleHIDValue(value);
+        LatencyTracker::endInput();
         CFRelease(value);
     }
 }
@@ -78,6 +85,9 @@ void USBDevice::disconnect() {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
+    if (connected) {
+        telemetry.recordDisconnected(deviceKey());
+    }
     connected = false;
     writeThreadRunning = false;
     writeQueueCV.notify_all();
@@ -121,19 +131,22 @@ void USBDevice::forceStateSync() {
     CFRelease(elements);
 }
 
-bool USBDevice::writeData(std::vector<uint8_t> data) {
+bool USBDevice::writeData(std::vector<uint8_t> data, std::chrono::steady_clock::time_point changedAt) {
     if (!hidDevice || !connected || data.empty()) {
         debug("HID device not open, not connected, or empty data\n");
         return false;
     }
 
+    latency.record(LatencyStage::OUTPUT_ENQUEUE, changedAt);
+
     {
         std::lock_guard<std::mutex> lock(writeQueueMutex);
         if (!connected || !writeThreadRunning) {
+            telemetry.recordDropped();
             return false;
         }
 
-        writeQueue.push(std::move(data));
+        writeQueue.push({.data = std::move(data), .changedAt = changedAt, .queuedAt = std::chrono::steady_clock::now()});
         writeQueueSize.store(writeQueue.size());
     }
     writeQueueCV.notify_one();
@@ -144,6 +157,8 @@ bool USBDevice::writeData(std::vector<uint8_t> data) {
 void USBDevice::writeThreadLoop() {
     while (writeThreadRunning) {
         std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point changedAt;
+        std::chrono::steady_clock::time_point queuedAt;
 
         {
             std::unique_lock<std::mutex> lock(writeQueueMutex);
@@ -152,9 +167,7 @@ void USBDevice::writeThreadLoop() {
             });
 
             if (!writeQueue.empty()) {
-                data = std::move(writeQueue.front());
-                writeQueue.pop();
-                writeQueueSize.store(writeQueue.size());
+                popWriteQueue(data, changedAt, queuedAt);
             } else if (!writeThreadRunning) {
                 break;
             }
@@ -165,8 +178,14 @@ void USBDevice::writeThreadLoop() {
             IOReturn kr = IOHIDDeviceSetReport(hidDevice, kIOHIDReportTypeOutput, reportID, data.data(), data.size());
             if (kr != kIOReturnSuccess) {
                 debug("IOHIDDeviceSetReport failed: %d\n", kr);
+                telemetry.recordDropped();
+            } else {
+                latency.record(LatencyStage::OUTPUT_WRITE, changedAt);
+                telemetry.recordWrite(data.size(), queuedAt);
             }
         }
+
+        recycleWriteBuffer(std::move(data));
     }
 }
 
@@ -191,6 +210,7 @@ void USBDevice::handleHIDValue(IOHIDValueRef value) {
         return;
     }
     const uint8_t *data = static_cast<const uint8_t *>(IOHIDValueGetBytePtr(value));
+    telemetry.recordInput(len);
 
     bool pressed = data[0] == 1;
     didReceiveButton(hardwareButtonIndex - 1, pressed);
@@ -20,6 +20,7 @@ USBDevice::USBDevice(HIDDeviceHandle aHidDevice, uint16_t aVendorId, uint16_t aP
 
 USBDevice::~USBDevice() {
     disconnect();
+    releaseDeviceKey();
 }
 
 bool USBDevice::connect() {
@@ -45,6 +46,7 @@ bool USBDevice::connect() {
     }
 
     connected = true;
+    telemetry.recordConnected(deviceKey());
     std::thread inputThread([this]() {
         uint8_t buffer[65];
         DWORD bytesRead;
@@ -71,6 +73,7 @@ bool USBDevice::connect() {
 }
 
 void USBDevice::InputReportCallback(void *context, DWORD bytesRead, uint8_t *report) {
+    auto readAt = std::chrono::steady_clock::now();
     auto *self = static_cast<USBDevice *>(context);
     if (!self || !self->connected || !report || bytesRead == 0) {
         return;
@@ -85,6 +88,7 @@ void USBDevice::InputReportCallback(void *context, DWORD bytesRead, uint8_t *rep
         event.reportId = report[0];
         event.reportData.assign(report, report + bytesRead);
         event.reportLength = (int) bytesRead;
+        event.readAt = readAt;
 
         self->processOnMainThread(event);
     } catch (const std::system_error &e) {
@@ -109,6 +113,9 @@ void USBDevice::disconnect() {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
+    if (connected) {
+        telemetry.recordDisconnected(deviceKey());
+    }
     writeThreadRunning = false;
     writeQueueCV.notify_all();
     if (writeThread.joinable()) {
@@ -132,7 +139,7 @@ void USBDevice::forceStateSync() {
     // noop, code does not use partial data
 }
 
-bool USBDevice::writeData(std::vector<uint8_t> data) {
+bool USBDevice::writeData(std::vector<uint8_t> data, std::chrono::steady_clock::time_point changedAt) {
     if (hidDevice == INVALID_HANDLE_VALUE || !connected || data.empty()) {
         debug("HID device not open, not connected, or empty data\n");
         return false;
@@ -143,9 +150,11 @@ bool USBDevice::writeData(std::vector<uint8_t> data) {
         return false;
     }
 
+    latency.record(LatencyStage::OUTPUT_ENQUEUE, changedAt);
+
     {
         std::lock_guard<std::mutex> lock(writeQueueMutex);
-        writeQueue.push(std::move(data));
+        writeQueue.push({.data = std::move(data), .changedAt = changedAt, .queuedAt = std::chrono::steady_clock::now()});
         writeQueueSize.store(writeQueue.size());
     }
     writeQueueCV.notify_one();
@@ -156,6 +165,8 @@ bool USBDevice::writeData(std::vector<uint8_t> data) {
 void USBDevice::writeThreadLoop() {
     while (writeThreadRunning) {
         std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point changedAt;
+        std::chrono::steady_clock::time_point queuedAt;
 
         {
             std::unique_lock<std::mutex> lock(writeQueueMutex);
@@ -168,20 +179,17 @@ void USBDevice::writeThreadLoop() {
             }
 
             if (!writeQueue.empty()) {
-                data = std::move(writeQueue.front());
-                writeQueue.pop();
-                writeQueueSize.store(writeQueue.size());
+                popWriteQueue(data, changedAt, queuedAt);
             }
         }
 
         if (!data.empty() && hidDevice != INVALID_HANDLE_VALUE && connected) {
-            std::vector<uint8_t> paddedData = data;
-            if (outputReportByteLength > 0 && paddedData.size() < outputReportByteLength) {
-                paddedData.resize(outputReportByteLength, 0);
+            if (outputReportByteLength > 0 && data.size() < outputReportByteLength) {
+                data.resize(outputReportByteLength, 0);
             }
 
             DWORD bytesWritten;
-            if (!WriteFile(hidDevice, paddedData.data(), (DWORD) paddedData.size(), &bytesWritten, nullptr)) {
+            if (!WriteFile(hidDevice, data.data(), (DWORD) data.size(), &bytesWritten, nullptr)) {
                 DWORD error = GetLastError();
                 const char *errorName = "UNKNOWN";
                 if (error == ERROR_DEVICE_NOT_CONNECTED) {
@@ -193,8 +201,14 @@ void USBDevice::writeThreadLoop() {
                 }
                 debug_force("WriteFile failed for %s (vendorId: 0x%04X, productId: 0x%04X): %lu (%s)\n",
                     productName.empty() ? "Unknown" : productName.c_str(), vendorId, productId, error, errorName);
+                telemetry.recordDropped();
+            } else {
+                latency.record(LatencyStage::OUTPUT_WRITE, changedAt);
+                telemetry.recordWrite(data.size(), queuedAt);
             }
         }
+
+        recycleWriteBuffer(std::move(data));
     }
 }
 #endif
@@ -2,10 +2,16 @@
 #error This is made to be compiled against the XPLM420 SDK for XP12
 #endif
 
+#include "aircraft-detector.h"
 #include "appstate.h"
 #include "config.h"
+#include "dataref-profiler.h"
 #include "dataref.h"
+#include "haptics-engine.h"
+#include "logger.h"
 #include "plugins-menu.h"
+#include "preferences.h"
+#include "render-worker.h"
 #include "usbcontroller.h"
 
 #include <algorithm>
@@ -96,6 +102,7 @@ void removeOldPlugin() { // remove <filesystem> when removing this function
             debug_force("Just try restarting X-Plane after this crash to complete the update.\n");
 
             // mini sleep to allow debug messages to flush
+            Logger::getInstance()->flush();
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
             int *crash = nullptr;
@@ -122,6 +129,22 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
         USBController::getInstance()->connectAllDevices();
     });
 
+    // Add "Profile datarefs" menu item, the profile is exported when it is turned off again
+    PluginsMenu::getInstance()->addPersistentItem("Profile datarefs", [](int itemIndex) {
+        bool profilingEnabled = !PluginsMenu::getInstance()->isItemChecked(itemIndex);
+
+        PluginsMenu::getInstance()->setItemName(itemIndex, profilingEnabled ? "Profiling datarefs, click to export" : "Profile datarefs");
+        PluginsMenu::getInstance()->setItemChecked(itemIndex, profilingEnabled);
+
+        if (profilingEnabled) {
+            DatarefProfiler::getInstance()->setEnabled(true);
+            debug_force("Dataref profiling started.\n");
+        } else {
+            DatarefProfiler::getInstance()->exportSnapshot();
+            DatarefProfiler::getInstance()->setEnabled(false);
+        }
+    });
+
     // Add "Enable debug logging" menu item
     PluginsMenu::getInstance()->addPersistentItem("Enable debug logging", [](int itemIndex) {
         bool debugLoggingEnabled = !PluginsMenu::getInstance()->isItemChecked(itemIndex);
@@ -145,7 +168,7 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
 
                 auto now = std::chrono::system_clock::now();
                 auto nowTimeT = std::chrono::system_clock::to_time_t(now);
-                auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+                auto nowMs = std::chrono::duration_cast<std::chrono::duration<long long, std::milli>>(now.time_since_epoch()) % 1000;
 
                 std::tm localTime;
 #if IBM
@@ -162,21 +185,49 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
                     debug_force("[%s.%03lld] - %s: %zu pending packets\n", timeBuffer, nowMs.count(), device->classIdentifier(), device->getWriteQueueSize());
                 }
 
-                // Report top dataref accesses
-                auto &stats = Dataref::getInstance()->getAccessStats();
-                if (!stats.empty()) {
-                    std::vector<std::pair<std::string, uint64_t>> sorted(stats.begin(), stats.end());
-                    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
-                        return a.second > b.second;
-                    });
+                // Report input/output latency per device
+                for (auto &device : USBController::getInstance()->devices) {
+                    for (int i = 0; i < LatencyTracker::StageCount; i++) {
+                        auto stage = static_cast<LatencyStage>(i);
+                        const auto &summary = device->latency.summary(stage);
+                        if (summary.count == 0) {
+                            continue;
+                        }
+
+                        debug_force("[%s.%03lld] - %s latency %s: p50 %.2f ms, p99 %.2f ms, max %.2f ms (%d samples)\n",
+                            timeBuffer, nowMs.count(), device->classIdentifier(), LatencyTracker::stageName(stage), summary.p50, summary.p99, summary.max, summary.count);
+                    }
+                }
+
+                // Report flight loop time against the frame budget
+                auto &governor = AppState::getInstance()->frameGovernor;
+                debug_force("[%s.%03lld] Frame time: avg %.3f ms, max %.3f ms, budget %.3f ms (%d frames over budget, %d refreshes deferred)\n",
+                    timeBuffer, nowMs.count(), governor.frameSummary().avg, governor.frameSummary().max, governor.budget(), governor.overBudgetFrames(), governor.deferredCount());
+                for (int i = 0; i < FrameGovernor::SubsystemCount; i++) {
+                    auto subsystem = static_cast<FrameSubsystem>(i);
+                    debug_force("[%s.%03lld] - %s: avg %.3f ms, max %.3f ms\n", timeBuffer, nowMs.count(), FrameGovernor::subsystemName(subsystem), governor.summary(subsystem).avg, governor.summary(subsystem).max);
+                }
 
-                    debug_force("[%s.%03lld] Top dataref accesses (last 5s):\n", timeBuffer, nowMs.count());
-                    size_t count = std::min(sorted.size(), size_t(10));
+                // Report packets saved by skipping unchanged frames
+                for (auto &device : USBController::getInstance()->devices) {
+                    uint64_t skipped = device->skippedPacketCount.exchange(0);
+                    if (skipped > 0) {
+                        debug_force("[%s.%03lld] - %s: %llu packets saved (%.1f/min)\n", timeBuffer, nowMs.count(), device->classIdentifier(), (unsigned long long) skipped, skipped * 12.0);
+                    }
+                }
+
+                // Report the most expensive datarefs
+                if (DatarefProfiler::getInstance()->isEnabled()) {
+                    auto rows = DatarefProfiler::getInstance()->snapshot();
+                    float seconds = DatarefProfiler::getInstance()->secondsProfiled();
+
+                    debug_force("[%s.%03lld] Top dataref accessor time (last %.0fs):\n", timeBuffer, nowMs.count(), seconds);
+                    size_t count = std::min(rows.size(), size_t(10));
                     for (size_t i = 0; i < count; i++) {
-                        debug_force("[%s.%03lld] - %s: %llu calls (%.1f/sec)\n",
-                            timeBuffer, nowMs.count(), sorted[i].first.c_str(), sorted[i].second, sorted[i].second / 5.0);
+                        const DatarefAccessStats &stats = rows[i].stats;
+                        debug_force("[%s.%03lld] - %s (%s): %.3f ms, %llu reads, %llu writes, %llu changes\n",
+                            timeBuffer, nowMs.count(), rows[i].ref.c_str(), rows[i].caller, std::chrono::duration<double, std::milli>(stats.accessorTime).count(), (unsigned long long) stats.reads, (unsigned long long) stats.writes, (unsigned long long) stats.changes);
                     }
-                    Dataref::getInstance()->resetAccessStats();
                 }
 
                 AppState::getInstance()->executeAfter(5000, *action);
@@ -197,9 +248,13 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
 
 PLUGIN_API void XPluginStop(void) {
     USBController::getInstance()->disconnectAllDevices();
+    RenderWorker::getInstance()->shutdown();
+    HapticsEngine::getInstance()->shutdown();
+    Preferences::getInstance()->shutdown();
     PluginsMenu::getInstance()->clearAllItems();
     AppState::getInstance()->deinitialize();
     debug_force("Plugin stopped\n");
+    Logger::getInstance()->shutdown();
 }
 
 PLUGIN_API int XPluginEnable(void) {
@@ -222,6 +277,7 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID from, long msg, void *params)
             }
 
             AppState::getInstance()->initialize();
+            AircraftDetector::getInstance()->planeLoaded();
             USBController::getInstance()->connectAllDevices();
             break;
         }
@@ -232,8 +288,9 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID from, long msg, void *params)
                 return;
             }
 
-            USBController::getInstance()->disconnectAllDevices();
-            PluginsMenu::getInstance()->clearAllItems();
+            // Devices stay connected across aircraft changes, only their profiles are swapped
+            USBController::getInstance()->unloadAllProfiles();
+            AircraftDetector::getInstance()->planeUnloaded();
             break;
         }
 
@@ -241,8 +298,12 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID from, long msg, void *params)
             break;
         }
 
+        case XPLM_MSG_DATAREFS_ADDED:
+            AircraftDetector::getInstance()->datarefsAdded();
+            break;
+
         case XPLM_MSG_WILL_WRITE_PREFS:
-            // AppState::getInstance()->saveState();
+            Preferences::getInstance()->flush();
             break;
 
         default: